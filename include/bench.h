@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+class Bench {
+public:
+    // Recherche une liste fixe de positions à profondeur fixe.
+    // Le total de noeuds sert de signature fonctionnelle (changement "no functional change"),
+    // le NPS de mesure de vitesse.
+    static uint64_t run(int depth, int threads, int hash_mb);
+};
@@ -20,6 +20,8 @@ public:
     
     // Zobrist hash key
     uint64_t hash_key;
+    // Clé des seuls pions (table de hachage des structures de pions)
+    uint64_t pawn_key;
 
     // Constructeur
     Board();
@@ -38,6 +40,13 @@ public:
     // Vérifications
     bool is_square_attacked(Square sq, Color by_color) const;
     bool is_in_check() const;
+
+    // Attaquants des deux couleurs sur une case, pour une occupation donnée
+    Bitboard attackers_to(Square sq, Bitboard occupied) const;
+
+    // Static Exchange Evaluation : la suite de captures sur la case d'arrivée
+    // rapporte-t-elle au moins threshold au camp qui joue ? (clouages ignorés)
+    bool see_ge(Move move, int threshold = 0) const;
     
     // Affichage
     void print() const;
@@ -3,16 +3,24 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <random>
+#include <cstdint>
 
 class Book {
 public:
     static void init();
     static Move get_book_move(const Board& board);
 
+    // Graine du tirage aléatoire entre les coups du livre (mode déterministe)
+    static void set_seed(uint32_t seed);
+
 private:
     // Map : FEN partiel -> Liste de coups possibles (en notation UCI "e2e4")
     static std::unordered_map<std::string, std::vector<std::string>> book_moves;
     
+    // Générateur propre au livre (indépendant de std::rand utilisé ailleurs)
+    static std::mt19937 rng;
+    
     // Helper pour nettoyer le FEN (garder seulement les pièces et le trait)
     static std::string clean_fen(const std::string& fen);
 };
\ No newline at end of file
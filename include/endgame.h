@@ -0,0 +1,43 @@
+#pragma once
+
+#include "board.h"
+
+// Score « gain connu » : au-dessus de toute évaluation normale, loin des scores de mat
+constexpr int VALUE_KNOWN_WIN = 10000;
+
+// Facteur d'échelle de l'évaluation, en 64es (64 = normal, 0 = nulle)
+constexpr int SCALE_NORMAL = 64;
+constexpr int SCALE_NONE = -1; // La fonction ne se prononce pas
+
+// Évaluation spécialisée, du point de vue du camp fort
+using EndgameEval = int (*)(const Board& board, Color strong);
+// Facteur d'échelle selon la position, ou SCALE_NONE
+using EndgameScale = int (*)(const Board& board, Color strong);
+
+// Finales connues, choisies par la table matérielle d'après le seul matériel
+class Endgames {
+public:
+    // Construit la bitbase KPK (après MoveGenerator::init)
+    static void init();
+
+    static int KXK(const Board& board, Color strong);   // Matériel suffisant contre roi seul
+    static int KBNK(const Board& board, Color strong);  // Mat Fou + Cavalier : vers le bon coin
+    static int KPK(const Board& board, Color strong);   // Bitbase
+    static int KRKP(const Board& board, Color strong);  // Tour contre pion
+    static int draw(const Board& board, Color strong);  // KNNK
+
+    // Fou de la mauvaise couleur avec pion(s) tour : nulle si le roi faible tient le coin
+    static int KBPsK(const Board& board, Color strong);
+
+    // Blancs (camp fort) : roi wk, pion psq ; Noirs : roi bk. Coordonnées A1=0,
+    // pion sur les colonnes a-d. stm : camp au trait (WHITE = camp fort)
+    static bool kpk_win(Square wk, Square psq, Square bk, Color stm);
+
+private:
+    static constexpr int KPK_SIZE = 2 * 24 * 64 * 64;
+    static uint8_t kpk[KPK_SIZE];
+
+    static int kpk_index(Color stm, Square bk, Square wk, Square psq);
+    static uint8_t kpk_initial(int idx);
+    static uint8_t kpk_classify(int idx);
+};
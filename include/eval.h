@@ -1,6 +1,7 @@
 #pragma once
 
 #include "board.h"
+#include <vector>
 
 class Evaluation {
 public:
@@ -12,9 +13,20 @@ public:
     static constexpr int QUEEN_VALUE = 900;
     static constexpr int KING_VALUE = 20000;
     
-    // Evaluate position from side_to_move's perspective
+    // Evaluate position from side_to_move's perspective.
+    // Goes through a per-thread direct-mapped cache keyed by hash_key. The TT already
+    // hands back the stored eval on a hit, so the cache only saves the evaluations
+    // the TT misses: entries overwritten in the TT, or never stored (search aborted)
     static int evaluate(const Board& board);
     
+    // Empty this thread's eval cache and reset its counters
+    static void clear_cache();
+    
+    // Eval cache hit rate ("ttstats")
+    static void print_stats();
+    
+    static constexpr int EVAL_CACHE_SIZE = 1 << 17; // Entries (8 bytes each), power of 2
+    
     // Get material value of a piece (public for move ordering)
     static int get_piece_value(Piece piece);
     
@@ -27,7 +39,13 @@ private:
     static const int QUEEN_PST[64];
     static const int KING_PST[64];
     
+    // Eval cache entry: upper 48 bits of the key | 16-bit score
+    static thread_local std::vector<uint64_t> eval_cache;
+    static thread_local uint64_t cache_probes;
+    static thread_local uint64_t cache_hits;
+    
     // Helper functions
     static int get_pst_value(Piece piece, Square sq);
+    static int compute(const Board& board);
 };
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "board.h"
+#include "endgame.h"
+#include <vector>
+
+// Table matérielle : tout ce qui ne dépend que du nombre de pièces de chaque
+// sorte (matériel, phase, déséquilibre, facteur d'échelle, finale connue) est
+// calculé une fois par configuration et gardé dans une table par thread.
+class Material {
+public:
+    // Valeurs Matérielles (MG = Milieu, EG = Finale)
+    // On donne un peu plus de valeur aux Fous/Cavaliers en finale pour encourager les échanges si on gagne
+    static constexpr int MG_VAL[6] = { 82, 337, 365, 477, 1025, 0 };
+    static constexpr int EG_VAL[6] = { 94, 281, 297, 512,  936, 0 };
+
+    // Poids de "Phase" : 0=Pion/Roi (ne comptent pas), 1=Cav/Fou, 2=Tour, 4=Dame
+    static constexpr int PHASE_INC[6] = { 0, 1, 1, 2, 4, 0 };
+    // Score Total possible de phase (4 Cav + 4 Fous + 4 Tours + 2 Dames) = 24
+    static constexpr int MAX_PHASE = 24;
+
+    struct Entry {
+        uint64_t key = ~0ULL;              // Nombres de pièces ; ~0 = entrée vide
+        int16_t mg = 0;                    // Matériel + déséquilibre, point de vue des Blancs
+        int16_t eg = 0;
+        uint8_t phase = 0;                 // MAX_PHASE (début) .. 0 (rois seuls)
+        uint8_t scale[2] = { SCALE_NORMAL, SCALE_NORMAL }; // Quand cette couleur est en tête
+        Color strong_side = WHITE;
+        EndgameEval eval_fn = nullptr;     // Finale connue : remplace l'évaluation
+        EndgameScale scale_fn[2] = { nullptr, nullptr };
+    };
+
+    static constexpr int TABLE_SIZE = 8192; // Puissance de 2
+
+    static Entry* probe(const Board& board);
+
+    // Facteur d'échelle (en 64es) quand la couleur strong est en tête
+    static int scale_factor(const Entry* e, const Board& board, Color strong);
+
+private:
+    static thread_local std::vector<Entry> table;
+
+    static void compute(Entry* e, const int count[12]);
+};
@@ -44,6 +44,9 @@ public:
     // Generate only legal moves
     static void generate_legal_moves(const class Board& board, std::vector<Move>& moves);
     
+    // Check that a move (e.g. from the TT) can be played here, ignoring checks
+    static bool is_pseudo_legal(const class Board& board, Move move);
+    
 private:
     // Helper functions for magic bitboards
     static Bitboard generate_bishop_attacks_mask(Square sq);
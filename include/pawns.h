@@ -0,0 +1,39 @@
+#pragma once
+
+#include "board.h"
+#include <vector>
+
+// Structure de pions : pions passés, isolés, doublés, arriérés et abri du roi.
+// Le résultat ne dépend que des pions (et de la case du roi pour l'abri) : il est
+// mis en cache dans une table par thread indexée par Board::pawn_key.
+class Pawns {
+public:
+    struct Entry {
+        uint64_t key = 0;
+        int16_t mg = 0;                      // Score pions, point de vue des Blancs
+        int16_t eg = 0;
+        int8_t king_sq[2] = { NO_SQ, NO_SQ }; // Case du roi pour laquelle l'abri est calculé
+        int16_t shelter[2] = { 0, 0 };       // Abri du roi (milieu de jeu), par couleur
+    };
+
+    static constexpr int TABLE_SIZE = 16384; // Puissance de 2
+
+    // Masques (après Bitboards::init)
+    static void init();
+
+    // Entrée de la position, calculée si la table ne la contient pas
+    static Entry* probe(const Board& board);
+
+    // Abri du roi de la couleur c, recalculé seulement quand le roi a bougé
+    static int king_shelter(Entry* e, const Board& board, Color c);
+
+private:
+    static thread_local std::vector<Entry> table;
+
+    static Bitboard passed_mask[2][64];  // Cases devant le pion, colonne et colonnes voisines
+    static Bitboard front_span[2][64];   // Cases devant le pion, même colonne
+    static Bitboard support_mask[2][64]; // Colonnes voisines, même rangée ou derrière
+    static Bitboard adjacent_files[8];
+
+    static void evaluate(Entry* e, const Board& board);
+};
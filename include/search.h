@@ -2,16 +2,54 @@
 #include "board.h"
 #include "movegenerator.h"
 #include "eval.h"
-#include <chrono>
+#include <vector>
+
+// Coup racine avec son score et sa variante principale (pour MultiPV)
+struct RootMove {
+    Move move = MOVE_NONE;
+    int score = -VALUE_INFINITE;
+    int previous_score = -VALUE_INFINITE;
+    uint64_t nodes = 0;  // Noeuds passés sous ce coup pendant l'itération
+    std::vector<Move> pv;
+};
+
+// Type de noeud : la recherche est instanciée pour chacun, les noeuds
+// hors variante principale (NON_PV, fenêtre nulle) suivent un chemin plus court
+enum NodeType { NON_PV, PV, ROOT };
+
+// Données de la recherche à un ply donné. Chaque noeud reçoit un pointeur ss
+// vers sa case et lit celles de ses parents (ss - 1, ss - 2).
+struct SearchStack {
+    int ply = 0;
+    uint64_t key = 0;                // Position (détection des répétitions)
+    int static_eval = 0;             // EVAL_NONE si en échec
+    Move killers[2] = {MOVE_NONE, MOVE_NONE};
+    Move current_move = MOVE_NONE;   // Coup joué depuis ce noeud (MOVE_NONE : null move)
+    int moved_piece = NO_PIECE;      // Pièce de current_move, pour les historiques
+    Move excluded_move = MOVE_NONE;  // Coup exclu (recherche de singularité du coup TT)
+    Move pv[MAX_PLY + 1] = {};       // Variante principale à partir de ce noeud
+    int pv_length = 0;
+};
 
 class Search {
 public:
+    // Précalcul des tables de la recherche (réductions LMR), à appeler au démarrage
+    static void init();
+
     // Fonction principale appelée par UCI
-    static Move get_best_move(Board& board, int max_depth, int time_limit_ms);
+    // Les limites de temps viennent de TimeManager (initialisé par UCI avant l'appel)
+    static Move get_best_move(Board& board, int max_depth);
 
     static void stop_search();
-    static void set_time_limit(int time_limit_ms);
     static void reset_stats();
+    static void set_multi_pv(int lines);
+
+    // Limites de recherche (go nodes / go mate), 0 = pas de limite
+    static void set_node_limit(uint64_t nodes);
+    static void set_mate_limit(int moves);
+
+    // Remise à zéro des tables de tri (ucinewgame)
+    static void clear();
 
     // Statistiques
     static uint64_t nodes_searched;
@@ -19,20 +57,56 @@ public:
 
     // --- ACCESSIBLES POUR SELFPLAY ---
     // On ajoute '= 0' pour que selfplay.cpp fonctionne sans avoir besoin de fournir 'ply'
+    // (choisissent le type de noeud d'après la fenêtre)
     static int negamax(Board& board, int depth, int alpha, int beta, int ply = 0);
     static int quiescence(Board& board, int alpha, int beta, int ply = 0);
 
 private:
+    // Recherche principale ; au noeud ROOT, les coups sont root_moves[pv_idx, fin)
+    // cut_node : noeud non-PV dont on attend un fail high
+    template <NodeType NT>
+    static int search(Board& board, SearchStack* ss, int depth, int alpha, int beta, bool cut_node);
+    template <NodeType NT>
+    static int qsearch(Board& board, SearchStack* ss, int alpha, int beta);
+
+    // Remet la pile à zéro (sauf les killers, effacés par clear())
+    static void reset_stack();
+
     // Heuristiques de tri
-    static int score_move(Move move, const Board& board, int ply, Move tt_move);
+    static int score_move(Move move, const Board& board, const SearchStack* ss, Move tt_move);
+    static int quiet_history(const SearchStack* ss, int piece, Square to);
+    static void update_history(int& entry, int bonus);
+    static void update_quiet_stats(const Board& board, SearchStack* ss, Move best_move, int depth,
+                                   const Move* quiets_tried, int quiet_count);
+    static void update_capture_history(const Board& board, Move move, int bonus);
 
-    // Gestion du temps
-    static std::chrono::steady_clock::time_point start_time;
-    static int allotted_time_ms;
+    // Gestion du temps et des limites
     static bool stop_flag;
+    static uint64_t node_limit;
+    static int mate_limit;
     static bool is_time_up();
+    static bool is_limit_reached();
+
+    // Vérification du coup nul : pas de coup nul avant ce ply (0 = autorisé partout)
+    static int nmp_min_ply;
 
     // Tables pour le tri des coups
-    static Move killer_moves[64][2];
     static int history[12][64];
+    static Move counter_moves[12][64];                     // [pièce précédente][case d'arrivée]
+    static int16_t continuation_history[2][12][64][12][64]; // [1 ou 2 plis][pièce, case précédentes][pièce, case]
+    static int capture_history[12][64][6];                  // [pièce qui prend][case][type capturé]
+
+    // Pile de recherche : STACK_OFFSET cases sentinelles avant la racine pour ss - 2
+    static constexpr int STACK_OFFSET = 2;
+    static SearchStack stack[MAX_PLY + STACK_OFFSET + 2];
+
+    // Coups racine de la recherche en cours et ligne MultiPV cherchée
+    static std::vector<RootMove> root_moves;
+    static int pv_idx;
+
+    // Réductions LMR précalculées [profondeur][numéro du coup]
+    static int reductions[64][64];
+
+    // Nombre de variantes à rapporter (option UCI MultiPV)
+    static int multi_pv;
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Gestion du temps : budget "soft" (on ne lance plus d'itération au-delà)
+// et budget "hard" (la recherche est interrompue net).
+class TimeManager {
+public:
+    // Calcule les budgets pour le coup à venir.
+    // time_left / increment : horloge du camp au trait (ms), moves_to_go : 0 si inconnu,
+    // move_time : temps fixe par coup (ms). Tout à 0 = pas de limite de temps.
+    static void init(int time_left, int increment, int moves_to_go, int move_time);
+
+    // Démarre le chronomètre (appelé au début de la recherche)
+    static void start();
+
+    // Option UCI "Move Overhead" : marge réservée pour la latence GUI/réseau
+    static void set_move_overhead(int ms);
+
+    static bool enabled() { return hard_limit_ms > 0; }
+    static int64_t elapsed();
+    static int64_t soft_limit() { return soft_limit_ms; }
+    static int64_t hard_limit() { return hard_limit_ms; }
+
+    // Décision entre deux itérations. Le budget soft est modulé par :
+    // - la stabilité du meilleur coup (nombre d'itérations sans changement)
+    // - la chute du score par rapport à l'itération précédente
+    // - la fraction des noeuds passée sur le meilleur coup racine
+    static bool should_stop(int best_move_stability, int score, int previous_score,
+                            double best_move_node_fraction);
+
+private:
+    static std::chrono::steady_clock::time_point start_time;
+    static int64_t soft_limit_ms;
+    static int64_t hard_limit_ms;
+    static int move_overhead_ms;
+};
@@ -2,6 +2,11 @@
 
 #include "types.h"
 #include <cstdint>
+#include <atomic>
+#include <string>
+#ifdef _MSC_VER
+    #include <xmmintrin.h>
+#endif
 
 // Transposition Table entry flags
 enum TTFlag {
@@ -10,45 +15,138 @@ enum TTFlag {
     TT_BETA = 2       // Lower bound (score >= beta)
 };
 
-// Transposition Table entry
+// Transposition Table entry, packed into 10 bytes: a 64-bit data word
+// (move, score, eval, depth, generation/bound) and a 16-bit key check.
+// Only the top 16 bits of the key are kept: the low bits already select the cluster
 struct TTEntry {
-    uint64_t key;      // Zobrist hash key (to verify it's the same position)
-    int score;         // Evaluation score
     Move move;         // Best move found (for move ordering)
-    int depth;         // Search depth
-    int flag;          // TT_EXACT, TT_ALPHA, or TT_BETA
+    int16_t score;     // Search score (mate scores node-relative)
+    int16_t eval;      // Static evaluation of the position (EVAL_NONE if in check)
+    uint8_t depth8;    // Search depth + 1 (0 = empty slot)
+    uint8_t gen_bound; // Generation (upper 6 bits) | TT_EXACT, TT_ALPHA, or TT_BETA (lower 2 bits)
+};
+
+// Cluster of entries sharing one index; 32 bytes so a probe touches a single cache line.
+// Lock-free: each data word is read and written atomically, and the stored key check is
+// key16 ^ fold(data), so an entry torn between two concurrent writers fails verification.
+constexpr int CLUSTER_SIZE = 3;
+
+struct alignas(32) TTCluster {
+    std::atomic<uint64_t> data[CLUSTER_SIZE];
+    std::atomic<uint16_t> key16[CLUSTER_SIZE];
+    char padding[2];
+};
+
+static_assert(sizeof(TTCluster) == 32, "TTCluster must be half a cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "TT needs lock-free 64-bit atomics");
+
+// Instrumentation counters, reset by TT::clear and printed by the "ttstats" command.
+// Updated with relaxed load+store (no locked add on the probe path): under
+// concurrent writers an increment can be lost, which is fine for statistics.
+struct TTStats {
+    std::atomic<uint64_t> probes{0};
+    std::atomic<uint64_t> hits{0};             // Key check matched
+    std::atomic<uint64_t> cutoffs{0};          // Hit usable for a cutoff
+    std::atomic<uint64_t> stores{0};
+    std::atomic<uint64_t> store_empty{0};      // Written into an empty slot
+    std::atomic<uint64_t> store_same{0};       // Updated the same position
+    std::atomic<uint64_t> store_kept{0};       // Same position, deeper entry kept
+    std::atomic<uint64_t> evict_old{0};        // Evicted another position from an older search
+    std::atomic<uint64_t> evict_current{0};    // Evicted another position from this search (collision)
 };
 
 class TT {
 public:
-    // Initialize transposition table with given size in MB
+    // Initialize (or resize) transposition table with given size in MB
+    // Memory is 2 MB-aligned and marked for transparent huge pages on Linux
     static void init(int size_mb);
     
-    // Clear the transposition table
+    // Clear the transposition table (in parallel for large tables)
     static void clear();
     
+    // Start a new search: entries from older searches become preferred victims.
+    // A mapped table's generation is shared and moves forward at most once a second
+    static void new_search();
+    
+    // Persistence. Zobrist keys come from a fixed seed, so a table saved by one run
+    // is valid in the next; the file header records a key fingerprint to make sure.
+    static bool save(const std::string& path);
+    static bool load(const std::string& path);
+    
+    // File-backed table: path is mapped with mmap (MAP_SHARED), so every store lands
+    // in the file and a later run starts with the warm table. An empty file is created
+    // with size_mb. A valid table of another size is recreated with size_mb when resize
+    // is set, otherwise it keeps its own size. Any other file is left untouched (false).
+    static bool map_file(const std::string& path, int size_mb, bool resize = true);
+    
+    // Table in a POSIX shared-memory segment (shm_open), same layout as the file mode.
+    // Every engine process attaching to the same name shares one table: the lock-free
+    // entries are safe across processes as they are across threads. The first process
+    // creates the segment with size_mb; the others wait for its header and attach at
+    // its size, never resizing a segment that may already be mapped.
+    static bool map_shared(const std::string& name, int size_mb);
+    
+    // True when the table lives in a file or shared memory (ucinewgame then keeps it)
+    static bool is_persistent();
+    
     // Probe the transposition table
-    // Returns true if entry found and usable, false otherwise
-    // If found, fills in score, move, depth, and flag
-    static bool probe(uint64_t key, int& score, Move& move, int& depth, int& flag, int current_depth, int alpha, int beta);
+    // Returns true if entry found and usable for a cutoff, false otherwise
+    // Whenever the key matches, fills in score, move, depth, flag, and eval (even if not usable)
+    // Mate scores come back relative to the root, using the probing node's ply
+    static bool probe(uint64_t key, int& score, Move& move, int& depth, int& flag, int& eval,
+                      int current_depth, int alpha, int beta, int ply);
+    
+    // Start loading the cluster of key into cache, ahead of probe/store.
+    // Called right after make_move, so the miss overlaps the legality check
+    static void prefetch(uint64_t key) {
+        if (!table) return;
+    #if defined(_MSC_VER)
+        _mm_prefetch(reinterpret_cast<const char*>(&table[key & mask]), _MM_HINT_T0);
+    #else
+        __builtin_prefetch(&table[key & mask]);
+    #endif
+    }
     
     // Store entry in transposition table
-    // Adjusts mate scores by ply for correct storage
-    static void store(uint64_t key, int score, Move move, int depth, int flag, int ply);
+    // Mate scores are converted from root-relative to node-relative using ply
+    // eval is the static evaluation, kept so later visits can skip Evaluation::evaluate
+    static void store(uint64_t key, int score, Move move, int depth, int flag, int eval, int ply);
     
-    // Get hash full percentage (for UCI info)
+    // Permille of the first 1000 clusters' entries written in the current search
     static int get_hash_full();
     
+    // Dump size, occupancy by age, probe and replacement statistics ("ttstats")
+    static void print_stats();
+    
 private:
-    static TTEntry* table;
-    static uint64_t size;          // Number of entries
+    static TTCluster* table;
+    static uint64_t size;          // Number of clusters
     static uint64_t mask;          // Bitmask for indexing (size - 1)
-    static uint64_t entries_written; // For hash full calculation
+    static uint8_t generation8;    // Current search generation, in the upper 6 bits
+    static TTStats stats;
+    
+    // Where the table memory comes from: large_page_alloc or a mapping (header + clusters)
+    enum class Backing { HEAP, MAPPED };
+    static Backing backing;
+    static void* mapping;
+    static uint64_t mapping_bytes;
+    
+    // Free or unmap the current table
+    static void release();
+    // Map an open hash file as the table (empty, or holding one of our tables)
+    static bool map_fd(int fd, int size_mb, const std::string& name);
+    // Make a mapping (header + clusters) the table
+    static void adopt_mapping(void* mem, uint64_t bytes, uint64_t clusters, bool reused, const std::string& name);
+    static void reset_stats();
+    
+    // Helpers: pack / unpack an entry into its 64-bit data word
+    static uint64_t pack(const TTEntry& entry);
+    static TTEntry unpack(uint64_t data);
     
-    // Helper: adjust mate scores for storage
+    // Helper: adjust mate scores for storage (root-relative -> node-relative)
     static int adjust_mate_score(int score, int ply);
     
-    // Helper: restore mate scores after retrieval
+    // Helper: restore mate scores after retrieval (node-relative -> root-relative)
     static int restore_mate_score(int score, int ply);
 };
 
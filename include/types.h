@@ -56,6 +56,25 @@ enum CastlingRights {
     WK = 1, WQ = 2, BK = 4, BQ = 8
 };
 
+// ============================================================================
+// SCORES
+// ============================================================================
+
+// Mate scores are ply-relative: being mated at ply p scores -(VALUE_MATE - p).
+// Anything beyond VALUE_MATE_IN_MAX_PLY is a mate score, and the TT converts
+// those between root-relative (search) and node-relative (storage) form.
+constexpr int MAX_PLY = 128;
+// Every score fits in 16 bits, as stored in the transposition table
+constexpr int VALUE_INFINITE = 32001;
+constexpr int VALUE_MATE = 32000;
+constexpr int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+constexpr int VALUE_MATED_IN_MAX_PLY = -VALUE_MATE_IN_MAX_PLY;
+// No static evaluation available (side to move in check, or not computed)
+constexpr int EVAL_NONE = -VALUE_INFINITE - 1;
+
+constexpr int mate_in(int ply) { return VALUE_MATE - ply; }
+constexpr int mated_in(int ply) { return -VALUE_MATE + ply; }
+
 // ============================================================================
 // MOVE REPRESENTATION
 // ============================================================================
@@ -13,9 +13,20 @@ public:
     // Main UCI loop
     void loop();
     
+    // Conversion coup -> notation UCI ("e2e4", "e7e8q")
+    static std::string move_to_string(Move move);
+    
+    // Score UCI : "cp <x>" ou "mate <n>" (n < 0 si on est maté)
+    static std::string score_to_string(int score);
+    
 private:
     Board board;
     bool quit_flag;
+    bool deterministic;  // Option "Deterministic" : livre à graine fixe, pas de limite de temps
+    int hash_mb;           // Option "Hash" (Mo)
+    bool hash_set = false; // "Hash" reçu : il impose sa taille à un fichier existant
+    std::string hash_file; // Option "Hash File" : table projetée en mémoire depuis ce fichier
+    std::string hash_shared; // Option "Hash Shared" : segment de mémoire partagée entre processus
     
     // UCI command handlers
     void handle_uci();
@@ -23,14 +34,14 @@ private:
     void handle_ucinewgame();
     void handle_position(const std::string& command);
     void handle_go(const std::string& command);
+    void handle_setoption(const std::string& command);
     void handle_quit();
     
+    // (Ré)alloue la table selon Hash / Hash Shared / Hash File
+    void apply_hash_options();
+    
     // Helper functions
     Square parse_square(const std::string& square_str);
     Move parse_move(const std::string& move_str);
-    std::string move_to_string(Move move);
-    
-    // Time management
-    int calculate_search_time(int time_left, int increment);
 };
 
@@ -15,5 +15,9 @@ namespace Zobrist {
     
     // Helper: generate a random 64-bit number
     uint64_t random_u64();
+    
+    // Fingerprint of the key set, stored with saved hash tables so that a
+    // table written with different keys is rejected
+    uint64_t signature();
 }
 
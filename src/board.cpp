@@ -24,6 +24,7 @@ void Board::clear_board() {
     halfmove_clock = 0;
     fullmove_number = 1;
     hash_key = 0;
+    pawn_key = 0;
 }
 
 void Board::update_occupancy() {
@@ -119,12 +120,16 @@ void Board::set_fen(const std::string& fen) {
     
     // Calculate full Zobrist hash from scratch
     hash_key = 0;
+    pawn_key = 0;
     
     // Hash all pieces
     for (Square sq = 0; sq < 64; sq++) {
         Piece piece = piece_at(sq);
         if (piece != NO_PIECE) {
             hash_key ^= Zobrist::piece_keys[piece][sq];
+            if (piece == WHITE_PAWN || piece == BLACK_PAWN) {
+                pawn_key ^= Zobrist::piece_keys[piece][sq];
+            }
         }
     }
     
@@ -234,17 +239,25 @@ void Board::make_move(Move move) {
     // Update hash: add piece to destination square (will be updated if promotion)
     hash_key ^= Zobrist::piece_keys[piece][to];
     
+    if (piece == WHITE_PAWN || piece == BLACK_PAWN) {
+        pawn_key ^= Zobrist::piece_keys[piece][from] ^ Zobrist::piece_keys[piece][to];
+    }
+    
     // Capture
     if (captured != NO_PIECE) {
         // Update hash: remove captured piece
         hash_key ^= Zobrist::piece_keys[captured][to];
         pieces[captured] = Bitboards::pop_bit(pieces[captured], to);
+        if (captured == WHITE_PAWN || captured == BLACK_PAWN) {
+            pawn_key ^= Zobrist::piece_keys[captured][to];
+        }
     }
     
     // Promotion
     if (move_type == MOVE_TYPE_PROMOTION) {
         // Update hash: remove pawn from destination
         hash_key ^= Zobrist::piece_keys[piece][to];
+        pawn_key ^= Zobrist::piece_keys[piece][to];
         pieces[piece] = Bitboards::pop_bit(pieces[piece], to);
         
         // Update hash: add promoted piece
@@ -259,6 +272,7 @@ void Board::make_move(Move move) {
         
         // Update hash: remove en passant captured pawn
         hash_key ^= Zobrist::piece_keys[ep_pawn][capture_sq];
+        pawn_key ^= Zobrist::piece_keys[ep_pawn][capture_sq];
         pieces[ep_pawn] = Bitboards::pop_bit(pieces[ep_pawn], capture_sq);
     }
     // Castling
@@ -403,6 +417,73 @@ bool Board::is_square_attacked(Square sq, Color by_color) const {
     return false;
 }
 
+Bitboard Board::attackers_to(Square sq, Bitboard occupied) const {
+    // Un pion blanc attaque sq s'il est sur une case attaquée par un pion noir placé en sq
+    Bitboard bishops = pieces[WHITE_BISHOP] | pieces[BLACK_BISHOP] | pieces[WHITE_QUEEN] | pieces[BLACK_QUEEN];
+    Bitboard rooks = pieces[WHITE_ROOK] | pieces[BLACK_ROOK] | pieces[WHITE_QUEEN] | pieces[BLACK_QUEEN];
+    return (MoveGenerator::get_pawn_attacks(sq, BLACK) & pieces[WHITE_PAWN])
+         | (MoveGenerator::get_pawn_attacks(sq, WHITE) & pieces[BLACK_PAWN])
+         | (MoveGenerator::get_knight_attacks(sq) & (pieces[WHITE_KNIGHT] | pieces[BLACK_KNIGHT]))
+         | (MoveGenerator::get_king_attacks(sq) & (pieces[WHITE_KING] | pieces[BLACK_KING]))
+         | (MoveGenerator::get_bishop_attacks(sq, occupied) & bishops)
+         | (MoveGenerator::get_rook_attacks(sq, occupied) & rooks);
+}
+
+// Valeurs utilisées par le SEE (le roi ne peut pas être pris)
+static constexpr int SEE_VALUE[6] = { 100, 320, 330, 500, 900, 0 };
+
+bool Board::see_ge(Move move, int threshold) const {
+    // Promotions, en passant et roques : on les considère comme neutres
+    if (get_move_type(move) != MOVE_TYPE_NORMAL) return threshold <= 0;
+
+    Square from = get_from_sq(move);
+    Square to = get_to_sq(move);
+
+    // swap : ce qu'il reste à gagner, du point de vue de celui qui vient de jouer
+    Piece captured = piece_at(to);
+    int swap = (captured == NO_PIECE ? 0 : SEE_VALUE[captured % 6]) - threshold;
+    if (swap < 0) return false;
+    swap = SEE_VALUE[piece_at(from) % 6] - swap;
+    if (swap <= 0) return true;
+
+    Bitboard occupied = occupancy[BOTH] ^ (1ULL << from) ^ (1ULL << to);
+    Bitboard attackers = attackers_to(to, occupied);
+    Bitboard bishops = pieces[WHITE_BISHOP] | pieces[BLACK_BISHOP] | pieces[WHITE_QUEEN] | pieces[BLACK_QUEEN];
+    Bitboard rooks = pieces[WHITE_ROOK] | pieces[BLACK_ROOK] | pieces[WHITE_QUEEN] | pieces[BLACK_QUEEN];
+    Color stm = side_to_move;
+    int result = 1;
+
+    while (true) {
+        stm = 1 - stm;
+        attackers &= occupied;
+        Bitboard stm_attackers = attackers & occupancy[stm];
+        if (!stm_attackers) break;
+        result ^= 1;
+
+        // Le moins précieux des attaquants reprend
+        int type = PAWN;
+        Bitboard bb = 0;
+        for (; type <= KING; ++type) {
+            bb = stm_attackers & pieces[type + 6 * stm];
+            if (bb) break;
+        }
+
+        // Le roi ne peut reprendre que si l'adversaire n'a plus d'attaquant
+        if (type == KING) return (attackers & occupancy[1 - stm]) ? result ^ 1 : result;
+
+        swap = SEE_VALUE[type] - swap;
+        if (swap < result) break;
+
+        occupied ^= bb & (0ULL - bb);
+        // Les pièces découvertes derrière celle qui vient de prendre entrent dans l'échange
+        if (type == PAWN || type == BISHOP || type == QUEEN)
+            attackers |= MoveGenerator::get_bishop_attacks(to, occupied) & bishops;
+        if (type == ROOK || type == QUEEN)
+            attackers |= MoveGenerator::get_rook_attacks(to, occupied) & rooks;
+    }
+    return result;
+}
+
 bool Board::is_in_check() const {
     int king_idx = (side_to_move == WHITE) ? WHITE_KING : BLACK_KING;
     Bitboard king_bb = pieces[king_idx];
@@ -6,9 +6,14 @@
 #include <iostream>
 
 std::unordered_map<std::string, std::vector<std::string>> Book::book_moves;
+std::mt19937 Book::rng;
+
+void Book::set_seed(uint32_t seed) {
+    rng.seed(seed);
+}
 
 void Book::init() {
-    std::srand(std::time(nullptr));
+    set_seed(static_cast<uint32_t>(std::time(nullptr)));
 
     // --- 1. DÉBUTS (Root) ---
     // rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq
@@ -142,7 +147,7 @@ Move Book::get_book_move(const Board& board) {
 
     if (book_moves.find(key) != book_moves.end()) {
         const auto& moves = book_moves[key];
-        int index = std::rand() % moves.size();
+        int index = static_cast<int>(rng() % moves.size());
         std::string move_str = moves[index];
         
         // Parsing simplifié
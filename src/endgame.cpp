@@ -0,0 +1,234 @@
+#include "endgame.h"
+#include "material.h"
+#include "movegenerator.h"
+#include <algorithm>
+#include <cstdlib>
+
+// ==========================================
+// 1. OUTILS
+// ==========================================
+
+// Les cases claires (A8=0 : a8 et h1 sont claires, a1 et h8 foncées)
+constexpr Bitboard LIGHT_SQUARES = 0xAA55AA55AA55AA55ULL;
+static_assert((LIGHT_SQUARES >> SQ_A8) & 1 && (LIGHT_SQUARES >> SQ_H1) & 1, "a8 et h1 sont claires");
+static_assert(!((LIGHT_SQUARES >> SQ_A1) & 1) && !((LIGHT_SQUARES >> SQ_H8) & 1), "a1 et h8 sont foncées");
+
+static int distance(Square a, Square b) {
+    return std::max(std::abs(rank_of(a) - rank_of(b)), std::abs(file_of(a) - file_of(b)));
+}
+
+// Roi faible vers le bord (90 dans un coin, 30 au centre)
+static int push_to_edge(Square sq) {
+    int r = std::min(rank_of(sq), 7 - rank_of(sq));
+    int f = std::min(file_of(sq), 7 - file_of(sq));
+    return 90 - 10 * (r + f);
+}
+
+// Rapprocher les rois (120 au contact)
+static int push_close(Square a, Square b) {
+    return 140 - 20 * distance(a, b);
+}
+
+static Square king_square(const Board& board, Color c) {
+    return Bitboards::get_lsb_index(board.pieces[c == WHITE ? WHITE_KING : BLACK_KING]);
+}
+
+// Case vue du camp fort joué par les Blancs, en coordonnées A1=0 (rangée 0 = sa 1re rangée)
+static Square normalize(Square sq, Color strong) {
+    return (strong == WHITE) ? (sq ^ 56) : sq;
+}
+
+static Bitboard piece_bb(const Board& board, Color c, int type) {
+    return board.pieces[c * 6 + type];
+}
+
+// ==========================================
+// 2. ÉVALUATIONS SPÉCIALISÉES
+// ==========================================
+
+int Endgames::KXK(const Board& board, Color strong) {
+    Color weak = 1 - strong;
+    Square strong_king = king_square(board, strong);
+    Square weak_king = king_square(board, weak);
+
+    int result = Bitboards::count_bits(piece_bb(board, strong, PAWN)) * Material::EG_VAL[PAWN];
+    for (int type = KNIGHT; type <= QUEEN; ++type) {
+        result += Bitboards::count_bits(piece_bb(board, strong, type)) * Material::MG_VAL[type];
+    }
+    result += push_to_edge(weak_king) + push_close(strong_king, weak_king);
+
+    Bitboard bishops = piece_bb(board, strong, BISHOP);
+    if (piece_bb(board, strong, QUEEN) || piece_bb(board, strong, ROOK)
+        || (bishops && piece_bb(board, strong, KNIGHT))
+        || ((bishops & LIGHT_SQUARES) && (bishops & ~LIGHT_SQUARES))) {
+        result = std::min(result + VALUE_KNOWN_WIN, VALUE_MATE_IN_MAX_PLY - 1);
+    }
+    return result;
+}
+
+int Endgames::KBNK(const Board& board, Color strong) {
+    Color weak = 1 - strong;
+    Square strong_king = king_square(board, strong);
+    Square weak_king = king_square(board, weak);
+
+    // Le mat ne se donne que dans un coin de la couleur du Fou
+    bool light = piece_bb(board, strong, BISHOP) & LIGHT_SQUARES;
+    Square corner1 = light ? SQ_A8 : SQ_A1;
+    Square corner2 = light ? SQ_H1 : SQ_H8;
+    int manhattan1 = std::abs(rank_of(weak_king) - rank_of(corner1)) + std::abs(file_of(weak_king) - file_of(corner1));
+    int manhattan2 = std::abs(rank_of(weak_king) - rank_of(corner2)) + std::abs(file_of(weak_king) - file_of(corner2));
+    int push_to_corner = 10 * (14 - std::min(manhattan1, manhattan2));
+
+    return VALUE_KNOWN_WIN + Material::MG_VAL[KNIGHT] + Material::MG_VAL[BISHOP]
+         + push_to_corner + push_close(strong_king, weak_king);
+}
+
+int Endgames::KPK(const Board& board, Color strong) {
+    Color weak = 1 - strong;
+    Square wk  = normalize(king_square(board, strong), strong);
+    Square bk  = normalize(king_square(board, weak), strong);
+    Square psq = normalize(Bitboards::get_lsb_index(piece_bb(board, strong, PAWN)), strong);
+
+    // Symétrie : pion sur les colonnes a-d
+    if (file_of(psq) >= 4) { wk ^= 7; bk ^= 7; psq ^= 7; }
+
+    Color stm = (board.side_to_move == strong) ? WHITE : BLACK;
+    if (!kpk_win(wk, psq, bk, stm)) return 0;
+
+    return VALUE_KNOWN_WIN + Material::EG_VAL[PAWN] + rank_of(psq);
+}
+
+int Endgames::KRKP(const Board& board, Color strong) {
+    Color weak = 1 - strong;
+    // A1=0, camp fort = Blancs : le pion noir descend vers la rangée 0
+    Square wk  = normalize(king_square(board, strong), strong);
+    Square bk  = normalize(king_square(board, weak), strong);
+    Square rsq = normalize(Bitboards::get_lsb_index(piece_bb(board, strong, ROOK)), strong);
+    Square psq = normalize(Bitboards::get_lsb_index(piece_bb(board, weak, PAWN)), strong);
+    Square queening = file_of(psq);
+    int weak_to_move = (board.side_to_move == weak) ? 1 : 0;
+    int rook = Material::EG_VAL[ROOK];
+
+    // Roi fort devant le pion, ou roi faible trop loin du pion et de la tour : gain
+    if (file_of(wk) == file_of(psq) && rank_of(wk) < rank_of(psq)) {
+        return rook - distance(wk, psq);
+    }
+    if (distance(bk, psq) >= 3 + weak_to_move && distance(bk, rsq) >= 3) {
+        return rook - distance(wk, psq);
+    }
+    // Pion avancé soutenu par son roi, roi fort loin : plutôt nulle
+    if (rank_of(bk) <= 2 && distance(bk, psq) == 1 && rank_of(wk) >= 3
+        && distance(wk, psq) > 2 + (1 - weak_to_move)) {
+        return 80 - 8 * distance(wk, psq);
+    }
+    return 200 - 8 * (distance(wk, psq - 8) - distance(bk, psq - 8) - distance(psq, queening));
+}
+
+int Endgames::draw(const Board&, Color) {
+    return 0;
+}
+
+int Endgames::KBPsK(const Board& board, Color strong) {
+    Bitboard pawns = piece_bb(board, strong, PAWN);
+    int file;
+    if (!(pawns & ~Bitboards::FILE_MASKS[0])) file = 0;
+    else if (!(pawns & ~Bitboards::FILE_MASKS[7])) file = 7;
+    else return SCALE_NONE;
+
+    Square queening = square_from_coords(strong == WHITE ? 0 : 7, file);
+    bool bishop_light = piece_bb(board, strong, BISHOP) & LIGHT_SQUARES;
+    bool queening_light = Bitboards::get_bit(LIGHT_SQUARES, queening);
+
+    if (bishop_light != queening_light && distance(king_square(board, 1 - strong), queening) <= 1) {
+        return 0;
+    }
+    return SCALE_NONE;
+}
+
+// ==========================================
+// 3. BITBASE KPK
+// ==========================================
+// Analyse rétrograde de toutes les positions Roi + Pion contre Roi, camp fort
+// ramené aux Blancs (A1=0, pion vers les grands index, colonnes a-d).
+// KING_ATTACKS ne dépend que de (index / 8, index % 8) : valable dans ce repère.
+
+enum KPKResult : uint8_t { KPK_INVALID = 0, KPK_UNKNOWN = 1, KPK_DRAW = 2, KPK_WIN = 4 };
+
+uint8_t Endgames::kpk[KPK_SIZE];
+
+// Attaques d'un pion blanc en A1=0
+static Bitboard kpk_pawn_attacks(Square psq) {
+    Bitboard b = 0;
+    if (file_of(psq) > 0) b |= 1ULL << (psq + 7);
+    if (file_of(psq) < 7) b |= 1ULL << (psq + 9);
+    return b;
+}
+
+int Endgames::kpk_index(Color stm, Square bk, Square wk, Square psq) {
+    return wk | (bk << 6) | (stm << 12) | (file_of(psq) << 13) | ((6 - rank_of(psq)) << 15);
+}
+
+uint8_t Endgames::kpk_initial(int idx) {
+    Square wk = idx & 63, bk = (idx >> 6) & 63;
+    Color stm = (idx >> 12) & 1;
+    Square psq = square_from_coords(6 - (idx >> 15), (idx >> 13) & 3);
+    Bitboard pawn_attacks = kpk_pawn_attacks(psq);
+
+    if (distance(wk, bk) <= 1 || wk == psq || bk == psq
+        || (stm == WHITE && Bitboards::get_bit(pawn_attacks, bk))) {
+        return KPK_INVALID;
+    }
+    // Promotion sans que la dame soit prise
+    if (stm == WHITE && rank_of(psq) == 6 && wk != psq + 8
+        && (distance(bk, psq + 8) > 1 || distance(wk, psq + 8) == 1)) {
+        return KPK_WIN;
+    }
+    // Pat, ou pion pris
+    if (stm == BLACK) {
+        Bitboard bk_moves = MoveGenerator::KING_ATTACKS[bk] & ~MoveGenerator::KING_ATTACKS[wk];
+        if (!(bk_moves & ~pawn_attacks) || Bitboards::get_bit(bk_moves, psq)) return KPK_DRAW;
+    }
+    return KPK_UNKNOWN;
+}
+
+uint8_t Endgames::kpk_classify(int idx) {
+    Square wk = idx & 63, bk = (idx >> 6) & 63;
+    Color stm = (idx >> 12) & 1;
+    Color them = 1 - stm;
+    Square psq = square_from_coords(6 - (idx >> 15), (idx >> 13) & 3);
+
+    // Les Blancs cherchent un successeur gagnant, les Noirs un successeur nul
+    uint8_t good = (stm == WHITE) ? KPK_WIN : KPK_DRAW;
+    uint8_t bad  = (stm == WHITE) ? KPK_DRAW : KPK_WIN;
+    uint8_t r = KPK_INVALID;
+
+    Bitboard b = MoveGenerator::KING_ATTACKS[stm == WHITE ? wk : bk];
+    while (b) {
+        Square s = Bitboards::pop_lsb(b);
+        r |= (stm == WHITE) ? kpk[kpk_index(them, bk, s, psq)] : kpk[kpk_index(them, s, wk, psq)];
+    }
+    if (stm == WHITE) {
+        if (rank_of(psq) < 6) r |= kpk[kpk_index(them, bk, wk, psq + 8)];
+        if (rank_of(psq) == 1 && psq + 8 != wk && psq + 8 != bk) r |= kpk[kpk_index(them, bk, wk, psq + 16)];
+    }
+
+    if (r & good) return good;
+    if (r & KPK_UNKNOWN) return KPK_UNKNOWN;
+    return bad;
+}
+
+void Endgames::init() {
+    for (int idx = 0; idx < KPK_SIZE; ++idx) kpk[idx] = kpk_initial(idx);
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int idx = 0; idx < KPK_SIZE; ++idx) {
+            if (kpk[idx] == KPK_UNKNOWN && (kpk[idx] = kpk_classify(idx)) != KPK_UNKNOWN) changed = true;
+        }
+    }
+}
+
+bool Endgames::kpk_win(Square wk, Square psq, Square bk, Color stm) {
+    return kpk[kpk_index(stm, bk, wk, psq)] == KPK_WIN;
+}
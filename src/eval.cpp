@@ -1,6 +1,9 @@
 #include "../include/eval.h"
 #include "../include/bitboard.h"
+#include "../include/pawns.h"
+#include "../include/material.h"
 #include <algorithm>
+#include <iostream>
 
 // On garde la déclaration externe pour le NNUE si vous voulez le mixer plus tard
 // Pour l'instant, on va se baser sur la solidité du code classique pour corriger les ouvertures
@@ -10,10 +13,7 @@ extern int evaluate_nnue(const Board& board);
 // 1. DÉFINITION DES TABLES (PESTO OPTIMISÉ)
 // ==========================================
 
-// Valeurs Matérielles (MG = Milieu, EG = Finale)
-// On donne un peu plus de valeur aux Fous/Cavaliers en finale pour encourager les échanges si on gagne
-const int MG_VAL[6] = { 82, 337, 365, 477, 1025, 0 };
-const int EG_VAL[6] = { 94, 281, 297, 512,  936, 0 };
+// Valeurs Matérielles et phase : voir Material (table matérielle)
 
 // TABLES MILIEU DE JEU (Middle Game) - Priorité : Sécurité & Activité
 const int MG_PAWN[64] = {
@@ -153,18 +153,12 @@ const int EG_KING[64] = {
 const int* MG_TABLES[6] = { MG_PAWN, MG_KNIGHT, MG_BISHOP, MG_ROOK, MG_QUEEN, MG_KING };
 const int* EG_TABLES[6] = { EG_PAWN, EG_KNIGHT, EG_BISHOP, EG_ROOK, EG_QUEEN, EG_KING };
 
-// Poids de "Phase" (pour savoir si on est en finale)
-// 0=Pion/Roi (ne comptent pas), 1=Cav/Fou, 2=Tour, 4=Dame
-const int GAME_PHASE_INC[6] = { 0, 1, 1, 2, 4, 0 };
-// Score Total possible de phase (4 Cav + 4 Fous + 4 Tours + 2 Dames) = 24
-const int MAX_PHASE = 24; 
-
 // ==========================================
 // 2. LOGIQUE D'ÉVALUATION (HYBRIDE & TAPERED)
 // ==========================================
 
 int Evaluation::get_piece_value(Piece piece) {
-    return MG_VAL[piece % 6]; // Valeur de base simple
+    return Material::MG_VAL[piece % 6]; // Valeur de base simple
 }
 
 int Evaluation::get_pst_value(Piece piece, Square sq) {
@@ -174,14 +168,22 @@ int Evaluation::get_pst_value(Piece piece, Square sq) {
     return MG_TABLES[type][idx];
 }
 
-int Evaluation::evaluate(const Board& board) {
+int Evaluation::compute(const Board& board) {
+    // 0. Table matérielle : matériel, phase, finales connues
+    Material::Entry* material = Material::probe(board);
+    if (material->eval_fn) {
+        int v = material->eval_fn(board, material->strong_side);
+        return (board.side_to_move == material->strong_side) ? v : -v;
+    }
+    // Aucun camp ne peut gagner (KK, KNK, KBK, KNKB...)
+    if (material->scale[WHITE] == 0 && material->scale[BLACK] == 0) return 0;
+
     // 1. Appel du Réseau de Neurones (Tactique pure)
     int nnue_score = evaluate_nnue(board);
     
     // 2. Calcul du "Tapered Eval" (Stratégie Classique)
     int mg[2] = {0, 0}; // Score Milieu de jeu (Blanc, Noir)
     int eg[2] = {0, 0}; // Score Finale (Blanc, Noir)
-    int phase = 0;
 
     for (int p = 0; p < 12; ++p) {
         Bitboard bb = board.pieces[p];
@@ -190,13 +192,6 @@ int Evaluation::evaluate(const Board& board) {
 
         while (bb) {
             Square sq = Bitboards::pop_lsb(bb);
-            
-            // Calcul de la phase (pour savoir si on est en finale)
-            phase += GAME_PHASE_INC[type];
-
-            // Matériel
-            mg[color] += MG_VAL[type];
-            eg[color] += EG_VAL[type];
 
             // Position (PST)
             // Pour les blancs : index normal. Pour les noirs : miroir (sq ^ 56)
@@ -210,12 +205,18 @@ int Evaluation::evaluate(const Board& board) {
     // 3. Interpolation de la Phase
     // Phase = 24 (Début) -> on utilise 100% MG
     // Phase = 0 (Rois seuls) -> on utilise 100% EG
-    if (phase > MAX_PHASE) phase = MAX_PHASE; // Sécurité
-    int mg_score = mg[WHITE] - mg[BLACK];
-    int eg_score = eg[WHITE] - eg[BLACK];
+    // Le matériel (avec le déséquilibre) et la phase viennent de la table matérielle
+    int phase = material->phase;
+    int mg_score = mg[WHITE] - mg[BLACK] + material->mg;
+    int eg_score = eg[WHITE] - eg[BLACK] + material->eg;
+
+    // Structure de pions : presque toujours dans la table des pions
+    Pawns::Entry* pawns = Pawns::probe(board);
+    mg_score += pawns->mg + Pawns::king_shelter(pawns, board, WHITE) - Pawns::king_shelter(pawns, board, BLACK);
+    eg_score += pawns->eg;
     
     // Formule : (MG * phase + EG * (24 - phase)) / 24
-    int classic_score = (mg_score * phase + eg_score * (MAX_PHASE - phase)) / MAX_PHASE;
+    int classic_score = (mg_score * phase + eg_score * (Material::MAX_PHASE - phase)) / Material::MAX_PHASE;
 
     // 4. Perspective (Blanc ou Noir ?)
     if (board.side_to_move == BLACK) {
@@ -226,6 +227,50 @@ int Evaluation::evaluate(const Board& board) {
     // On mélange les deux pour avoir le meilleur des deux mondes.
     // Le NNUE voit les tactiques, le Classique (PST) force le bon placement.
     // On donne un peu plus de poids au NNUE car il est plus précis tactiquement.
-    
-    return (nnue_score * 3 + classic_score) / 4;
-}
\ No newline at end of file
+    int score = (nnue_score * 3 + classic_score) / 4;
+
+    // 6. Facteur d'échelle du camp en tête (finales nulles ou difficiles à gagner)
+    Color leader = (score > 0) ? board.side_to_move : 1 - board.side_to_move;
+    return score * Material::scale_factor(material, board, leader) / SCALE_NORMAL;
+}
+
+// ==========================================
+// 3. CACHE D'ÉVALUATION
+// ==========================================
+
+thread_local std::vector<uint64_t> Evaluation::eval_cache;
+thread_local uint64_t Evaluation::cache_probes = 0;
+thread_local uint64_t Evaluation::cache_hits = 0;
+
+constexpr uint64_t EVAL_KEY_MASK = ~0xFFFFULL;
+
+int Evaluation::evaluate(const Board& board) {
+    if (eval_cache.empty()) eval_cache.assign(EVAL_CACHE_SIZE, 0);
+
+    uint64_t& slot = eval_cache[board.hash_key & (EVAL_CACHE_SIZE - 1)];
+    cache_probes++;
+    if ((slot & EVAL_KEY_MASK) == (board.hash_key & EVAL_KEY_MASK)) {
+        cache_hits++;
+        return static_cast<int16_t>(slot & 0xFFFF);
+    }
+
+    // Toutes les évaluations tiennent sur 16 bits (finales connues < VALUE_MATE_IN_MAX_PLY)
+    int score = compute(board);
+    slot = (board.hash_key & EVAL_KEY_MASK) | static_cast<uint16_t>(score);
+    return score;
+}
+
+void Evaluation::clear_cache() {
+    std::fill(eval_cache.begin(), eval_cache.end(), 0);
+    cache_probes = cache_hits = 0;
+}
+
+void Evaluation::print_stats() {
+    double rate = cache_probes ? 100.0 * static_cast<double>(cache_hits) / static_cast<double>(cache_probes) : 0.0;
+    std::cout << std::fixed;
+    std::cout.precision(1);
+    std::cout << "Eval cache      : " << (EVAL_CACHE_SIZE * sizeof(uint64_t)) / 1024 << " KB, probes "
+              << cache_probes << ", hits " << cache_hits << " (" << rate << "%)" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    std::cout.precision(6);
+}
@@ -5,16 +5,35 @@
 #include "tt.h"
 #include "book.h"
 #include "selfplay.h"
+#include "bench.h"
+#include "pawns.h"
+#include "endgame.h"
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
 
 int main(int argc, char* argv[]) {
     // Initialize engine components
     Bitboards::init();
+    Pawns::init();
     MoveGenerator::init();
+    Endgames::init();
     Zobrist::init_zobrist();
     Book::init();
+    Search::init();
+
+    // --- MODE BENCH ---
+    // chess_engine bench [depth] [threads] [hash]
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int depth = (argc > 2) ? std::atoi(argv[2]) : 6;
+        int threads = (argc > 3) ? std::atoi(argv[3]) : 1;
+        int hash_mb = (argc > 4) ? std::atoi(argv[4]) : 16;
+        TT::init(hash_mb);
+        Bench::run(depth, threads, hash_mb);
+        return 0;
+    }
+
     TT::init(64);  // Initialize TT with 64MB
 
     // --- MODE SELF-PLAY ---
@@ -0,0 +1,109 @@
+#include "material.h"
+#include <algorithm>
+
+// Déséquilibre (Kaufman) : le Cavalier gagne avec les pions, la Tour perd,
+// indexé par le nombre de pions de son camp
+const int KNIGHT_ADJ[9] = { -20, -16, -12, -8, -4,  0,  4,  8, 12 };
+const int ROOK_ADJ[9]   = {  15,  12,   9,  6,  3,  0, -3, -6, -9 };
+const int BISHOP_PAIR_MG = 30, BISHOP_PAIR_EG = 50;
+
+thread_local std::vector<Material::Entry> Material::table;
+
+Material::Entry* Material::probe(const Board& board) {
+    if (table.empty()) table.resize(TABLE_SIZE);
+
+    // Clé exacte : 4 bits par sorte de pièce (rois exclus)
+    int count[12];
+    uint64_t key = 0;
+    for (int p = 0; p < 12; ++p) {
+        count[p] = Bitboards::count_bits(board.pieces[p]);
+        if (p % 6 != KING) key |= uint64_t(count[p]) << (4 * p);
+    }
+
+    Entry* e = &table[(key * 0x9E3779B97F4A7C15ULL) >> 51]; // 13 bits : TABLE_SIZE
+    if (e->key == key) return e;
+
+    *e = Entry();
+    e->key = key;
+    compute(e, count);
+    return e;
+}
+
+void Material::compute(Entry* e, const int count[12]) {
+    int mg[2] = { 0, 0 }, eg[2] = { 0, 0 }, npm[2] = { 0, 0 };
+    int phase = 0;
+
+    for (int c = WHITE; c <= BLACK; ++c) {
+        const int* n = count + 6 * c;
+        for (int type = PAWN; type < KING; ++type) {
+            mg[c] += n[type] * MG_VAL[type];
+            eg[c] += n[type] * EG_VAL[type];
+            if (type != PAWN) npm[c] += n[type] * MG_VAL[type];
+            phase += n[type] * PHASE_INC[type];
+        }
+
+        int pawns = std::min(n[PAWN], 8);
+        int imbalance = n[KNIGHT] * KNIGHT_ADJ[pawns] + n[ROOK] * ROOK_ADJ[pawns];
+        mg[c] += imbalance;
+        eg[c] += imbalance;
+        if (n[BISHOP] >= 2) {
+            mg[c] += BISHOP_PAIR_MG;
+            eg[c] += BISHOP_PAIR_EG;
+        }
+    }
+
+    e->mg = static_cast<int16_t>(mg[WHITE] - mg[BLACK]);
+    e->eg = static_cast<int16_t>(eg[WHITE] - eg[BLACK]);
+    e->phase = static_cast<uint8_t>(std::min(phase, MAX_PHASE));
+
+    for (int c = WHITE; c <= BLACK; ++c) {
+        Color them = 1 - c;
+        const int* us = count + 6 * c;
+        const int* th = count + 6 * them;
+        bool them_bare = npm[them] == 0 && th[PAWN] == 0;
+
+        // Finales connues
+        EndgameEval fn = nullptr;
+        if (them_bare && us[PAWN] == 0 && us[KNIGHT] == 2 && npm[c] == 2 * MG_VAL[KNIGHT]) {
+            fn = &Endgames::draw; // KNNK
+        } else if (them_bare && us[PAWN] == 0 && us[KNIGHT] == 1 && us[BISHOP] == 1
+                   && npm[c] == MG_VAL[KNIGHT] + MG_VAL[BISHOP]) {
+            fn = &Endgames::KBNK;
+        } else if (them_bare && npm[c] >= MG_VAL[ROOK]) {
+            fn = &Endgames::KXK;
+        } else if (them_bare && npm[c] == 0 && us[PAWN] == 1) {
+            fn = &Endgames::KPK;
+        } else if (npm[c] == MG_VAL[ROOK] && us[ROOK] == 1 && us[PAWN] == 0
+                   && npm[them] == 0 && th[PAWN] == 1) {
+            fn = &Endgames::KRKP;
+        }
+        if (fn) {
+            e->eval_fn = fn;
+            e->strong_side = c;
+            break;
+        }
+    }
+
+    for (int c = WHITE; c <= BLACK; ++c) {
+        Color them = 1 - c;
+        const int* us = count + 6 * c;
+
+        // Fou et pions seuls : nulle possible avec le Fou de la mauvaise couleur
+        if (npm[c] == MG_VAL[BISHOP] && us[BISHOP] == 1 && us[PAWN] > 0) {
+            e->scale_fn[c] = &Endgames::KBPsK;
+        }
+
+        // Sans pions, une petite avance en pièces ne gagne pas (KNK, KBK, KRKB, ...)
+        if (us[PAWN] == 0 && npm[c] - npm[them] <= MG_VAL[BISHOP]) {
+            e->scale[c] = npm[c] < MG_VAL[ROOK] ? 0 : (npm[them] <= MG_VAL[BISHOP] ? 4 : 14);
+        }
+    }
+}
+
+int Material::scale_factor(const Entry* e, const Board& board, Color strong) {
+    if (e->scale_fn[strong]) {
+        int sf = e->scale_fn[strong](board, strong);
+        if (sf != SCALE_NONE) return sf;
+    }
+    return e->scale[strong];
+}
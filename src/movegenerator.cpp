@@ -393,6 +393,43 @@ void MoveGenerator::generate_legal_moves(const Board& board, std::vector<Move>&
     }
 }
 
+bool MoveGenerator::is_pseudo_legal(const Board& board, Move move) {
+    if (move == MOVE_NONE) return false;
+
+    Color side = board.side_to_move;
+    Square from = get_from_sq(move);
+    Square to = get_to_sq(move);
+    Piece piece = board.piece_at(from);
+
+    // Une pièce à nous sur la case de départ, pas sur celle d'arrivée
+    if (piece == NO_PIECE || piece / 6 != side) return false;
+    if (Bitboards::get_bit(board.occupancy[side], to)) return false;
+
+    int type = piece % 6;
+
+    // Pions et coups spéciaux (promotion, en passant, roque) : on compare avec la génération
+    if (type == PAWN || get_move_type(move) != MOVE_TYPE_NORMAL) {
+        std::vector<Move> moves;
+        if (type == PAWN) generate_pawn_moves(board, moves);
+        else if (type == KING) generate_king_moves(board, moves);
+        for (Move m : moves) {
+            if (m == move) return true;
+        }
+        return false;
+    }
+
+    Bitboard occupied = board.occupancy[BOTH];
+    Bitboard attacks = 0;
+    switch (type) {
+        case KNIGHT: attacks = get_knight_attacks(from); break;
+        case BISHOP: attacks = get_bishop_attacks(from, occupied); break;
+        case ROOK:   attacks = get_rook_attacks(from, occupied); break;
+        case QUEEN:  attacks = get_queen_attacks(from, occupied); break;
+        case KING:   attacks = get_king_attacks(from); break;
+    }
+    return Bitboards::get_bit(attacks, to);
+}
+
 // void MoveGenerator::generate_moves(const Board& board, std::vector<Move>& moves) {
 //     moves.clear();
 //     generate_pawn_moves(board, moves);
@@ -0,0 +1,144 @@
+#include "pawns.h"
+#include <algorithm>
+#include <cstdlib>
+
+// ==========================================
+// 1. PARAMÈTRES (MG, EG)
+// ==========================================
+
+// Bonus pion passé selon la rangée relative (0 = 1re rangée du camp)
+// Les PST de finale récompensent déjà l'avance des pions : on reste modéré
+const int PASSED_MG[8] = { 0, 0,  5, 10, 20, 35,  60, 0 };
+const int PASSED_EG[8] = { 0, 5, 10, 20, 35, 60, 100, 0 };
+
+const int ISOLATED_MG = -10, ISOLATED_EG = -15;
+const int DOUBLED_MG  = -10, DOUBLED_EG  = -25;
+const int BACKWARD_MG =  -8, BACKWARD_EG = -12;
+
+// Abri du roi : pénalité selon la distance du pion le plus proche devant le roi
+// (index 0 = pas de pion sur la colonne)
+const int SHELTER_PENALTY[4] = { -30, 0, -10, -20 };
+const int OPEN_FILE_PENALTY = -10; // Colonne sans aucun pion devant le roi
+
+// ==========================================
+// 2. TABLE & MASQUES
+// ==========================================
+
+thread_local std::vector<Pawns::Entry> Pawns::table;
+
+Bitboard Pawns::passed_mask[2][64];
+Bitboard Pawns::front_span[2][64];
+Bitboard Pawns::support_mask[2][64];
+Bitboard Pawns::adjacent_files[8];
+
+void Pawns::init() {
+    for (int f = 0; f < 8; ++f) {
+        adjacent_files[f] = (f > 0 ? Bitboards::FILE_MASKS[f - 1] : 0)
+                          | (f < 7 ? Bitboards::FILE_MASKS[f + 1] : 0);
+    }
+
+    for (Square sq = 0; sq < 64; ++sq) {
+        int r = rank_of(sq), f = file_of(sq);
+        // Rangées devant le pion : vers la rangée 0 pour les Blancs, vers 7 pour les Noirs
+        Bitboard ahead[2] = { 0, 0 }, behind_or_level[2] = { 0, 0 };
+        for (int rr = 0; rr < 8; ++rr) {
+            if (rr < r) ahead[WHITE] |= Bitboards::RANK_MASKS[rr];
+            if (rr > r) ahead[BLACK] |= Bitboards::RANK_MASKS[rr];
+            if (rr >= r) behind_or_level[WHITE] |= Bitboards::RANK_MASKS[rr];
+            if (rr <= r) behind_or_level[BLACK] |= Bitboards::RANK_MASKS[rr];
+        }
+        for (int c = WHITE; c <= BLACK; ++c) {
+            front_span[c][sq]   = ahead[c] & Bitboards::FILE_MASKS[f];
+            passed_mask[c][sq]  = ahead[c] & (Bitboards::FILE_MASKS[f] | adjacent_files[f]);
+            support_mask[c][sq] = behind_or_level[c] & adjacent_files[f];
+        }
+    }
+}
+
+// ==========================================
+// 3. ÉVALUATION DE LA STRUCTURE
+// ==========================================
+
+Pawns::Entry* Pawns::probe(const Board& board) {
+    if (table.empty()) table.resize(TABLE_SIZE);
+
+    Entry* e = &table[board.pawn_key & (TABLE_SIZE - 1)];
+    // Une entrée vierge (clé 0) est juste pour une position sans pions
+    if (e->key == board.pawn_key) return e;
+
+    *e = Entry();
+    e->key = board.pawn_key;
+    evaluate(e, board);
+    return e;
+}
+
+void Pawns::evaluate(Entry* e, const Board& board) {
+    const Bitboard not_a = ~Bitboards::FILE_MASKS[0];
+    const Bitboard not_h = ~Bitboards::FILE_MASKS[7];
+    Bitboard pawns[2] = { board.pieces[WHITE_PAWN], board.pieces[BLACK_PAWN] };
+
+    // Cases attaquées par les pions (A8=0 : les Blancs montent vers les petits index)
+    Bitboard attacks[2] = {
+        ((pawns[WHITE] & not_a) >> 9) | ((pawns[WHITE] & not_h) >> 7),
+        ((pawns[BLACK] & not_a) << 7) | ((pawns[BLACK] & not_h) << 9)
+    };
+
+    int mg[2] = { 0, 0 }, eg[2] = { 0, 0 };
+
+    for (int c = WHITE; c <= BLACK; ++c) {
+        Color them = 1 - c;
+        Bitboard bb = pawns[c];
+        while (bb) {
+            Square sq = Bitboards::pop_lsb(bb);
+            int f = file_of(sq);
+            int rel_rank = (c == WHITE) ? 7 - rank_of(sq) : rank_of(sq);
+            Square stop = (c == WHITE) ? sq - 8 : sq + 8;
+
+            bool isolated = !(pawns[c] & adjacent_files[f]);
+            bool doubled  = pawns[c] & front_span[c][sq];
+            bool passed   = !(pawns[them] & passed_mask[c][sq]) && !doubled;
+            // Arriéré : aucun pion voisin pour le soutenir et la case d'arrêt est tenue
+            bool backward = !isolated && !passed
+                         && !(pawns[c] & support_mask[c][sq])
+                         && Bitboards::get_bit(attacks[them], stop);
+
+            if (passed)   { mg[c] += PASSED_MG[rel_rank]; eg[c] += PASSED_EG[rel_rank]; }
+            if (isolated) { mg[c] += ISOLATED_MG;         eg[c] += ISOLATED_EG; }
+            if (doubled)  { mg[c] += DOUBLED_MG;          eg[c] += DOUBLED_EG; }
+            if (backward) { mg[c] += BACKWARD_MG;         eg[c] += BACKWARD_EG; }
+        }
+    }
+
+    e->mg = static_cast<int16_t>(mg[WHITE] - mg[BLACK]);
+    e->eg = static_cast<int16_t>(eg[WHITE] - eg[BLACK]);
+}
+
+int Pawns::king_shelter(Entry* e, const Board& board, Color c) {
+    Square ksq = Bitboards::get_lsb_index(board.pieces[c == WHITE ? WHITE_KING : BLACK_KING]);
+    if (ksq < 0) return 0;
+    if (e->king_sq[c] == ksq) return e->shelter[c];
+
+    Bitboard ours = board.pieces[c == WHITE ? WHITE_PAWN : BLACK_PAWN];
+    Bitboard all  = board.pieces[WHITE_PAWN] | board.pieces[BLACK_PAWN];
+    int center = std::clamp(file_of(ksq), 1, 6);
+    int shelter = 0;
+
+    for (int f = center - 1; f <= center + 1; ++f) {
+        Square from = square_from_coords(rank_of(ksq), f);
+        Bitboard span = front_span[c][from];
+
+        // Pion ami le plus proche devant le roi sur cette colonne
+        int distance = 0;
+        Bitboard bb = ours & span;
+        while (bb) {
+            int d = std::abs(rank_of(Bitboards::pop_lsb(bb)) - rank_of(ksq));
+            if (distance == 0 || d < distance) distance = d;
+        }
+        shelter += SHELTER_PENALTY[std::min(distance, 3)];
+        if (!(all & span)) shelter += OPEN_FILE_PENALTY;
+    }
+
+    e->king_sq[c] = static_cast<int8_t>(ksq);
+    e->shelter[c] = static_cast<int16_t>(shelter);
+    return shelter;
+}
@@ -2,72 +2,207 @@
 #include "../include/types.h"
 #include "../include/book.h"
 #include "../include/tt.h" 
+#include "../include/uci.h"
+#include "../include/timeman.h"
 #include <algorithm>
 #include <iostream>
 #include <vector>
+#include <cmath>
 
 // Init static
 uint64_t Search::nodes_searched = 0;
 int Search::max_depth_reached = 0;
-std::chrono::steady_clock::time_point Search::start_time;
-int Search::allotted_time_ms = 0;
 bool Search::stop_flag = false;
+uint64_t Search::node_limit = 0;
+int Search::mate_limit = 0;
+int Search::nmp_min_ply = 0;
 
-Move Search::killer_moves[64][2] = {};
 int Search::history[12][64] = {};
+Move Search::counter_moves[12][64] = {};
+int16_t Search::continuation_history[2][12][64][12][64] = {};
+int Search::capture_history[12][64][6] = {};
+SearchStack Search::stack[MAX_PLY + STACK_OFFSET + 2];
+std::vector<RootMove> Search::root_moves;
+int Search::pv_idx = 0;
+int Search::reductions[64][64] = {};
+int Search::multi_pv = 1;
+
+void Search::init() {
+    // Réduction logarithmique : croît lentement avec la profondeur et le rang du coup
+    for (int d = 0; d < 64; ++d) {
+        for (int m = 0; m < 64; ++m) {
+            if (d == 0 || m == 0) { reductions[d][m] = 0; continue; }
+            reductions[d][m] = static_cast<int>(0.75 + std::log(d) * std::log(m) / 2.25);
+        }
+    }
+    reset_stack();
+}
 
-// --- NOUVEAU : Historique de la branche de recherche ---
-// Sert à détecter les répétitions DANS le calcul (ex: perpétuel)
-static uint64_t search_ply_history[256]; 
+void Search::reset_stack() {
+    for (int i = 0; i < MAX_PLY + STACK_OFFSET + 2; ++i) {
+        SearchStack& s = stack[i];
+        s.ply = i - STACK_OFFSET;
+        s.key = 0;
+        s.static_eval = EVAL_NONE;
+        s.current_move = MOVE_NONE;
+        s.moved_piece = NO_PIECE;
+        s.excluded_move = MOVE_NONE;
+        s.pv_length = 0;
+    }
+}
 
 void Search::reset_stats() {
     nodes_searched = 0;
     max_depth_reached = 0;
     stop_flag = false;
+    nmp_min_ply = 0;
 }
 
 void Search::stop_search() { stop_flag = true; }
-void Search::set_time_limit(int time_limit_ms) { allotted_time_ms = time_limit_ms; }
+void Search::set_multi_pv(int lines) { multi_pv = std::max(1, lines); }
+void Search::set_node_limit(uint64_t nodes) { node_limit = nodes; }
+void Search::set_mate_limit(int moves) { mate_limit = std::max(0, moves); }
+
+void Search::clear() {
+    for (auto& s : stack) s.killers[0] = s.killers[1] = MOVE_NONE;
+    for (auto& h : history) std::fill(std::begin(h), std::end(h), 0);
+    for (auto& c : counter_moves) std::fill(std::begin(c), std::end(c), MOVE_NONE);
+    std::fill(&continuation_history[0][0][0][0][0],
+              &continuation_history[0][0][0][0][0] + sizeof(continuation_history) / sizeof(int16_t), 0);
+    std::fill(&capture_history[0][0][0], &capture_history[0][0][0] + 12 * 64 * 6, 0);
+    Evaluation::clear_cache();
+}
 
 bool Search::is_time_up() {
-    if (allotted_time_ms <= 0) return false;
-    if ((nodes_searched & 4095) == 0) {
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count() >= allotted_time_ms) 
+    if (!TimeManager::enabled()) return false;
+    // Vérification fréquente : en bullet, 4096 noeuds représentaient déjà ~30 ms
+    if ((nodes_searched & 1023) == 0) {
+        if (TimeManager::elapsed() >= TimeManager::hard_limit()) 
             return true;
     }
     return false;
 }
 
+bool Search::is_limit_reached() {
+    // La limite de noeuds est vérifiée à chaque noeud : le compte est exact,
+    // donc indépendant de la vitesse de la machine
+    if (node_limit && nodes_searched >= node_limit) return true;
+    return is_time_up();
+}
+
+// Le camp au trait a-t-il autre chose que des pions (et le roi) ?
+// Assez de matériel pour que le zugzwang soit improbable : une Tour ou une Dame, ou deux
+// pièces mineures. Avec des pions seuls ou une pièce mineure seule, le coup nul ment trop souvent
+static bool has_null_move_material(const Board& board) {
+    int base = (board.side_to_move == WHITE) ? WHITE_KNIGHT : BLACK_KNIGHT;
+    if ((board.pieces[base + 2] | board.pieces[base + 3]) != 0) return true;
+    return Bitboards::count_bits(board.pieces[base] | board.pieces[base + 1]) >= 2;
+}
+
 // Vérifie si la position actuelle est une répétition dans la branche de recherche
-bool is_repetition(uint64_t hash, int ply) {
+static bool is_repetition(const SearchStack* ss) {
     // On regarde les positions précédentes dans la ligne actuelle
     // On remonte par pas de 2 (car une répétition survient après un coup à nous + un coup à eux)
-    for (int i = ply - 2; i >= 0; i -= 2) {
-        if (search_ply_history[i] == hash) return true;
+    for (int i = 2; i <= ss->ply; i += 2) {
+        if ((ss - i)->key == ss->key) return true;
     }
     return false;
 }
 
-int Search::score_move(Move move, const Board& board, int ply, Move tt_move) {
-    if (move == tt_move) return 20000;
+// Ordre de tri : TT > captures (MVV + historique des captures) > killers > counter move > quiets (historiques)
+constexpr int SCORE_TT_MOVE = 1000000;
+constexpr int SCORE_CAPTURE = 500000;
+constexpr int SCORE_KILLER_1 = 400000;
+constexpr int SCORE_KILLER_2 = 390000;
+constexpr int SCORE_COUNTER = 380000;
+
+// Les historiques restent dans [-MAX_HISTORY, MAX_HISTORY] (mise à jour "gravity")
+constexpr int MAX_HISTORY = 16384;
+
+static int history_bonus(int depth) {
+    return std::min(16 * depth * depth + 32 * depth + 16, 1200);
+}
+
+int Search::score_move(Move move, const Board& board, const SearchStack* ss, Move tt_move) {
+    if (move == tt_move) return SCORE_TT_MOVE;
 
-    int captured = board.piece_at(get_to_sq(move));
+    Square to = get_to_sq(move);
+    int p = board.piece_at(get_from_sq(move));
+    int captured = board.piece_at(to);
     if (captured != NO_PIECE && captured <= 11) {
+        // MVV d'abord, corrigé par ce que la recherche a appris de cette capture
         int victim = Evaluation::get_piece_value((Piece)captured);
-        int attacker = Evaluation::get_piece_value((Piece)board.piece_at(get_from_sq(move)));
-        return 10000 + victim * 10 - attacker;
+        return SCORE_CAPTURE + victim * 16 + capture_history[p][to][captured % 6] / 2;
     }
     
-    if (ply < 64) {
-        if (move == killer_moves[ply][0]) return 9000;
-        if (move == killer_moves[ply][1]) return 8000;
-    }
+    if (move == ss->killers[0]) return SCORE_KILLER_1;
+    if (move == ss->killers[1]) return SCORE_KILLER_2;
     
+    if (p < 0 || p > 11) return 0;
+
+    // Réponse habituelle au coup précédent de l'adversaire
+    const SearchStack* prev = ss - 1;
+    if (prev->moved_piece != NO_PIECE
+        && move == counter_moves[prev->moved_piece][get_to_sq(prev->current_move)])
+        return SCORE_COUNTER;
+
+    return quiet_history(ss, p, to);
+}
+
+int Search::quiet_history(const SearchStack* ss, int piece, Square to) {
+    int score = history[piece][to];
+    // Les cases sentinelles avant la racine ont moved_piece == NO_PIECE
+    for (int back = 1; back <= 2; ++back) {
+        const SearchStack* prev = ss - back;
+        if (prev->moved_piece == NO_PIECE) continue;
+        score += continuation_history[back - 1][prev->moved_piece][get_to_sq(prev->current_move)][piece][to];
+    }
+    return score;
+}
+
+void Search::update_history(int& entry, int bonus) {
+    // Gravity : plus l'entrée est grande, moins le bonus la fait bouger
+    entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+void Search::update_capture_history(const Board& board, Move move, int bonus) {
     int p = board.piece_at(get_from_sq(move));
-    if (p >= 0 && p <= 11) return history[p][get_to_sq(move)];
-    
-    return 0;
+    Square to = get_to_sq(move);
+    int captured = board.piece_at(to);
+    if (p == NO_PIECE || captured == NO_PIECE) return;
+    update_history(capture_history[p][to][captured % 6], bonus);
+}
+
+void Search::update_quiet_stats(const Board& board, SearchStack* ss, Move best_move, int depth,
+                                const Move* quiets_tried, int quiet_count) {
+    if (ss->killers[0] != best_move) {
+        ss->killers[1] = ss->killers[0];
+        ss->killers[0] = best_move;
+    }
+    const SearchStack* prev = ss - 1;
+    if (prev->moved_piece != NO_PIECE)
+        counter_moves[prev->moved_piece][get_to_sq(prev->current_move)] = best_move;
+
+    int bonus = history_bonus(depth);
+    // Bonus pour le coup qui a coupé, malus pour les quiets essayés avant lui
+    for (int i = 0; i <= quiet_count; ++i) {
+        Move m = (i == quiet_count) ? best_move : quiets_tried[i];
+        if (m == best_move && i != quiet_count) continue;
+        int delta = (m == best_move) ? bonus : -bonus;
+        int p = board.piece_at(get_from_sq(m));
+        Square to = get_to_sq(m);
+        if (p == NO_PIECE) continue;
+
+        update_history(history[p][to], delta);
+        for (int back = 1; back <= 2; ++back) {
+            const SearchStack* before = ss - back;
+            if (before->moved_piece == NO_PIECE) continue;
+            int16_t& cont = continuation_history[back - 1][before->moved_piece][get_to_sq(before->current_move)][p][to];
+            int value = cont;
+            update_history(value, delta);
+            cont = static_cast<int16_t>(value);
+        }
+    }
 }
 
 bool is_legal(const Board& board) {
@@ -79,152 +214,426 @@ bool is_legal(const Board& board) {
     return !board.is_square_attacked(king_sq, board.side_to_move);
 }
 
-int Search::quiescence(Board& board, int alpha, int beta, int ply) {
-    if (is_time_up()) stop_flag = true;
+// Marge du delta pruning : ce qu'un coup calme (position) peut ajouter à une capture
+constexpr int DELTA_MARGIN = 200;
+
+template <NodeType NT>
+int Search::qsearch(Board& board, SearchStack* ss, int alpha, int beta) {
+    constexpr bool pv_node = (NT == PV);
+
+    if (is_limit_reached()) stop_flag = true;
     if (stop_flag) return 0;
     nodes_searched++;
 
     // En Quiescence, on ne vérifie pas strictement la répétition pour la vitesse,
-    // mais on enregistre quand même le hash pour negamax.
-    if (ply < 256) search_ply_history[ply] = board.hash_key;
+    // mais on enregistre quand même le hash pour search.
+    ss->key = board.hash_key;
+    if (pv_node) ss->pv_length = 0;
 
-    int stand_pat = Evaluation::evaluate(board);
-    if (stand_pat >= beta) return beta;
-    if (alpha < stand_pat) alpha = stand_pat;
+    bool in_check = board.is_in_check();
+    if (ss->ply >= MAX_PLY - 1) return in_check ? 0 : Evaluation::evaluate(board);
+
+    // Sonde TT à profondeur 0 : toute entrée de la recherche principale convient aussi
+    int tt_score = 0; Move tt_move = MOVE_NONE; int tt_depth = -1; int tt_flag = 0; int tt_eval = EVAL_NONE;
+    bool tt_cutoff = TT::probe(board.hash_key, tt_score, tt_move, tt_depth, tt_flag, tt_eval, 0, alpha, beta, ss->ply);
+    if (!pv_node && tt_cutoff) return tt_score;
+    // Clé de 16 bits seulement : le coup peut venir d'une autre position
+    if (tt_move != MOVE_NONE && !MoveGenerator::is_pseudo_legal(board, tt_move)) tt_move = MOVE_NONE;
+
+    const int alpha_orig = alpha;
+    int best_score = -VALUE_INFINITE;
+    int stand_pat = EVAL_NONE;
+
+    // En échec, pas de stand pat : toutes les parades sont cherchées
+    if (!in_check) {
+        // L'évaluation statique gardée dans la TT évite un appel à evaluate
+        stand_pat = (tt_eval != EVAL_NONE) ? tt_eval : Evaluation::evaluate(board);
+        if (stand_pat >= beta) {
+            TT::store(board.hash_key, stand_pat, MOVE_NONE, 0, TT_BETA, stand_pat, ss->ply);
+            return stand_pat;
+        }
+        best_score = stand_pat;
+        if (stand_pat > alpha) alpha = stand_pat;
+    }
 
     std::vector<Move> moves;
     moves.reserve(64);
     MoveGenerator::generate_pseudo_moves(board, moves);
 
-    std::vector<std::pair<int, Move>> captures;
-    captures.reserve(moves.size());
+    // Hors échec : captures (prise en passant comprise) et promotions en dame
+    std::vector<std::pair<int, Move>> sorted_moves;
+    sorted_moves.reserve(moves.size());
     for (Move m : moves) {
-        if (board.piece_at(get_to_sq(m)) != NO_PIECE) 
-            captures.push_back({score_move(m, board, 0, MOVE_NONE), m});
+        if (!in_check) {
+            bool is_capture = board.piece_at(get_to_sq(m)) != NO_PIECE
+                              || get_move_type(m) == MOVE_TYPE_EN_PASSANT;
+            bool queen_promotion = get_move_type(m) == MOVE_TYPE_PROMOTION && get_promotion(m) == QUEEN - KNIGHT;
+            if (!is_capture && !queen_promotion) continue;
+        }
+        sorted_moves.push_back({score_move(m, board, ss, tt_move), m});
     }
-    std::sort(captures.rbegin(), captures.rend());
+    std::sort(sorted_moves.rbegin(), sorted_moves.rend());
 
-    for (const auto& pair : captures) {
+    Move best_move_found = MOVE_NONE;
+    int legal_moves_count = 0;
+
+    for (const auto& pair : sorted_moves) {
         Move move = pair.second;
+
+        if (!in_check && get_move_type(move) != MOVE_TYPE_PROMOTION) {
+            // Delta pruning : même en gagnant la pièce prise plus une marge, on reste sous alpha
+            Piece captured = board.piece_at(get_to_sq(move));
+            int gain = (captured == NO_PIECE) ? Evaluation::get_piece_value(WHITE_PAWN)
+                                              : Evaluation::get_piece_value(captured);
+            if (stand_pat + gain + DELTA_MARGIN <= alpha) {
+                best_score = std::max(best_score, stand_pat + gain + DELTA_MARGIN);
+                continue;
+            }
+            // Captures perdantes d'après l'échange statique
+            if (!board.see_ge(move, 0)) continue;
+        }
+
         Board next = board;
         next.make_move(move);
+        TT::prefetch(next.hash_key);
         
         if (!is_legal(next)) continue;
+        legal_moves_count++;
+
+        ss->current_move = move;
+        ss->moved_piece = board.piece_at(get_from_sq(move));
 
-        int score = -quiescence(next, -beta, -alpha, ply + 1);
+        if (pv_node) (ss + 1)->pv_length = 0;
+        int score = -qsearch<NT>(next, ss + 1, -beta, -alpha);
         
         if (stop_flag) return 0;
-        if (score >= beta) return beta;
-        if (score > alpha) alpha = score;
+
+        if (score > best_score) {
+            best_score = score;
+            if (score > alpha) {
+                best_move_found = move;
+                if (pv_node) {
+                    ss->pv[0] = move;
+                    int child_length = std::min((ss + 1)->pv_length, MAX_PLY - 1);
+                    for (int p = 0; p < child_length; ++p) ss->pv[p + 1] = (ss + 1)->pv[p];
+                    ss->pv_length = child_length + 1;
+                }
+                if (score >= beta) break;
+                alpha = score;
+            }
+        }
     }
-    return alpha;
+
+    // En échec sans parade : mat
+    if (in_check && legal_moves_count == 0) return mated_in(ss->ply);
+
+    int flag = TT_ALPHA;
+    if (best_score >= beta) flag = TT_BETA;
+    else if (best_score > alpha_orig) flag = TT_EXACT;
+    TT::store(board.hash_key, best_score, best_move_found, 0, flag, stand_pat, ss->ply);
+
+    return best_score;
 }
 
-int Search::negamax(Board& board, int depth, int alpha, int beta, int ply) {
-    if (is_time_up()) stop_flag = true;
+template <NodeType NT>
+int Search::search(Board& board, SearchStack* ss, int depth, int alpha, int beta, bool cut_node) {
+    constexpr bool root_node = (NT == ROOT);
+    constexpr bool pv_node = (NT != NON_PV);
+
+    if (is_limit_reached()) stop_flag = true;
     if (stop_flag) return 0;
 
-    // --- DETECTION REPETITION ---
-    // Si on rencontre la même position dans cette branche, c'est NUL (0).
-    // Si on est gagnant (+500), le moteur verra que 0 < 500 et évitera cette branche.
-    if (ply > 0 && is_repetition(board.hash_key, ply)) {
-        return 0; 
-    }
-    // On enregistre la position actuelle dans l'historique
-    if (ply < 256) search_ply_history[ply] = board.hash_key;
-    // ----------------------------
-
-    int tt_score = 0; Move tt_move = MOVE_NONE; int tt_depth = 0; int tt_flag = 0;
-    if (TT::probe(board.hash_key, tt_score, tt_move, tt_depth, tt_flag, depth, alpha, beta)) {
-        // Attention: ne pas retourner un score TT si c'est une répétition qu'on n'a pas vue
-        // Mais pour l'instant, on garde simple.
-        return tt_score;
+    if (pv_node) ss->pv_length = 0;
+    ss->key = board.hash_key;
+
+    if (!root_node) {
+        // --- DETECTION REPETITION ---
+        // Si on rencontre la même position dans cette branche, c'est NUL (0).
+        // Si on est gagnant (+500), le moteur verra que 0 < 500 et évitera cette branche.
+        if (is_repetition(ss)) return 0;
+
+        // Pile pleine : on s'arrête sur l'évaluation
+        if (ss->ply >= MAX_PLY - 1) return Evaluation::evaluate(board);
+
+        // --- MATE DISTANCE PRUNING ---
+        // Même un mat immédiat ne battrait pas un mat plus court déjà trouvé plus haut
+        alpha = std::max(alpha, mated_in(ss->ply));
+        beta = std::min(beta, mate_in(ss->ply + 1));
+        if (alpha >= beta) return alpha;
     }
 
+    // Le coup qui donne échec est prolongé (voir la boucle), mais les réductions peuvent quand
+    // même amener une position en échec à profondeur <= 0 : coup calme réduit par LMR, recherches
+    // réduites de ProbCut et du coup nul. On la cherche alors à profondeur 1, avant la sonde TT
+    // pour que sonde et stockage utilisent la même profondeur. Hors échec, on passe directement
+    // en quiescence, qui sonde la TT elle-même.
     bool in_check = board.is_in_check();
-    if (in_check) depth++;
+    if (depth <= 0) {
+        if (!in_check) return qsearch<pv_node ? PV : NON_PV>(board, ss, alpha, beta);
+        depth = 1;
+    }
+
+    const Move excluded = ss->excluded_move;
+    const int alpha_orig = alpha;
+
+    // La racine ordonne ses coups elle-même (root_moves), pas besoin de la TT
+    int tt_score = 0; Move tt_move = MOVE_NONE; int tt_depth = -1; int tt_flag = 0; int tt_eval = EVAL_NONE;
+    if (!root_node) {
+        bool tt_cutoff = TT::probe(board.hash_key, tt_score, tt_move, tt_depth, tt_flag, tt_eval,
+                                   depth, alpha, beta, ss->ply);
+        // Pas de coupure TT dans une recherche d'exclusion : l'entrée concerne la position complète.
+        // Ni dans un noeud PV : la variante principale serait tronquée.
+        if (!pv_node && tt_cutoff && excluded == MOVE_NONE) {
+            return tt_score;
+        }
+        // Clé de 16 bits seulement (et TT partagée sans verrou) : le coup peut venir
+        // d'une autre position, on le vérifie avant de s'en servir
+        if (tt_move != MOVE_NONE && !MoveGenerator::is_pseudo_legal(board, tt_move)) tt_move = MOVE_NONE;
+    }
 
-    if (depth <= 0) return quiescence(board, alpha, beta, ply);
     nodes_searched++;
 
-    int static_eval = Evaluation::evaluate(board);
+    // Évaluation statique : reprise de la TT si la position y est déjà (même si la sonde
+    // n'a pas permis de couper), inutile en échec où aucun élagage ne s'en sert
+    int static_eval = EVAL_NONE;
+    if (!in_check) static_eval = (tt_eval != EVAL_NONE) ? tt_eval : Evaluation::evaluate(board);
+
+    // La position s'améliore-t-elle par rapport à notre coup précédent (2 plis plus tôt) ?
+    ss->static_eval = static_eval;
+    bool improving = !in_check && (ss - 2)->static_eval != EVAL_NONE
+                     && static_eval > (ss - 2)->static_eval;
+
+    // Élagages avant la boucle : seulement dans les noeuds à fenêtre nulle
+    if (!pv_node && !in_check && excluded == MOVE_NONE) {
+        // 1. REVERSE FUTILITY PRUNING (RFP)
+        if (depth <= 7) {
+            int margin = 80 * depth; 
+            if (static_eval - margin >= beta) return static_eval;
+        }
 
-    // 1. REVERSE FUTILITY PRUNING (RFP)
-    if (depth <= 7 && !in_check && ply > 0) {
-        int margin = 80 * depth; 
-        if (static_eval - margin >= beta) return static_eval;
-    }
+        // 2. NULL MOVE PRUNING
+        // Joué en place (make_null_move / unmake_null_move), jamais deux fois de suite,
+        // et pas quand il ne reste que des pions ou une pièce mineure : le zugzwang y est fréquent
+        // (kbK5/pp6/1P6/8/8/8/8/R7 w : 1.Ta6! met les Noirs, un Fou seul, en zugzwang).
+        if (depth >= 3 && static_eval >= beta && ss->ply >= nmp_min_ply
+            && (ss - 1)->current_move != MOVE_NONE && has_null_move_material(board)) {
+            // R croît avec la profondeur et avec l'avance de l'éval sur beta
+            int R = 3 + depth / 4 + std::min((static_eval - beta) / 200, 3);
+
+            ss->current_move = MOVE_NONE;
+            ss->moved_piece = NO_PIECE;
+            board.make_null_move();
+            TT::prefetch(board.hash_key);
+            int score = -search<NON_PV>(board, ss + 1, depth - 1 - R, -beta, -beta + 1, !cut_node);
+            board.unmake_null_move();
+            if (stop_flag) return 0;
+
+            if (score >= beta) {
+                // Pas de mat non prouvé renvoyé par un coup nul
+                if (score >= VALUE_MATE_IN_MAX_PLY) score = beta;
+                if (depth < 12 || nmp_min_ply != 0) return score;
+
+                // Vérification à grande profondeur : même recherche réduite, mais sans coup nul
+                // pour nous dans les premiers plis, ce qui attrape les zugzwangs restants
+                nmp_min_ply = ss->ply + 3 * (depth - 1 - R) / 4;
+                int verified = search<NON_PV>(board, ss, depth - 1 - R, beta - 1, beta, false);
+                nmp_min_ply = 0;
+                if (stop_flag) return 0;
+                if (verified >= beta) return score;
+            }
+        }
 
-    // 2. NULL MOVE PRUNING
-    if (depth >= 3 && !in_check && ply > 0 && static_eval >= beta) {
-        Board copy = board;
-        copy.make_null_move();
-        // Null move ne change pas le hash de la même façon, attention à l'historique (on ignore ici)
-        
-        int R = 2; 
-        if (depth > 6) R = 3;
-        
-        int score = -negamax(copy, depth - 1 - R, -beta, -beta + 1, ply + 1);
-        if (stop_flag) return 0;
-        if (score >= beta) return beta;
+        // 3. RAZORING
+        if (depth <= 3) {
+            int margin = 300 * depth;
+            if (static_eval + margin < alpha) {
+                int q_score = qsearch<NON_PV>(board, ss, alpha, beta);
+                if (q_score < alpha) return q_score;
+            }
+        }
     }
 
-    // 3. RAZORING
-    if (depth <= 3 && !in_check && ply > 0) {
-        int margin = 300 * depth;
-        if (static_eval + margin < alpha) {
-            int q_score = quiescence(board, alpha, beta, ply);
-            if (q_score < alpha) return q_score;
+    // 4. INTERNAL ITERATIVE REDUCTION (IIR)
+    // Sans coup TT, le tri est mauvais : on cherche un ply moins profond, l'itération
+    // suivante retrouvera la position avec un coup TT. Seulement là où un coup doit
+    // être trouvé (noeuds PV et cut nodes).
+    if (!root_node && (pv_node || cut_node) && depth >= 4 && tt_move == MOVE_NONE && excluded == MOVE_NONE)
+        depth--;
+
+    // 5. PROBCUT
+    // Si une capture gagnante dépasse nettement beta dans une recherche réduite,
+    // la recherche complète dépasserait très probablement beta aussi.
+    const int probcut_beta = beta + 200;
+    if (!pv_node && !in_check && depth >= 5 && excluded == MOVE_NONE
+        && std::abs(beta) < VALUE_MATE_IN_MAX_PLY
+        // Inutile si la TT affirme déjà, à profondeur suffisante, que le score reste sous probcut_beta
+        && !(tt_depth >= depth - 3 && tt_score < probcut_beta && tt_flag != TT_BETA)) {
+        std::vector<Move> moves;
+        moves.reserve(64);
+        MoveGenerator::generate_pseudo_moves(board, moves);
+
+        std::vector<std::pair<int, Move>> captures;
+        for (Move m : moves) {
+            bool is_capture = board.piece_at(get_to_sq(m)) != NO_PIECE;
+            bool queen_promotion = get_move_type(m) == MOVE_TYPE_PROMOTION && get_promotion(m) == QUEEN - KNIGHT;
+            if (!is_capture && !queen_promotion) continue;
+            // Il faut gagner au moins l'écart entre l'éval et probcut_beta
+            if (!board.see_ge(m, probcut_beta - static_eval)) continue;
+            captures.push_back({score_move(m, board, ss, tt_move), m});
+        }
+        std::sort(captures.rbegin(), captures.rend());
+
+        for (const auto& pair : captures) {
+            Move move = pair.second;
+            Board next = board;
+            next.make_move(move);
+            TT::prefetch(next.hash_key);
+            if (!is_legal(next)) continue;
+
+            ss->current_move = move;
+            ss->moved_piece = board.piece_at(get_from_sq(move));
+
+            // Vérification rapide en quiescence, puis recherche réduite
+            int score = -qsearch<NON_PV>(next, ss + 1, -probcut_beta, -probcut_beta + 1);
+            if (score >= probcut_beta)
+                score = -search<NON_PV>(next, ss + 1, depth - 4, -probcut_beta, -probcut_beta + 1, !cut_node);
+            if (stop_flag) return 0;
+
+            if (score >= probcut_beta) {
+                TT::store(board.hash_key, score, move, depth - 3, TT_BETA, static_eval, ss->ply);
+                return score;
+            }
         }
     }
 
-    std::vector<Move> moves;
-    moves.reserve(256);
-    MoveGenerator::generate_pseudo_moves(board, moves);
+    // 6. SINGULAR EXTENSION
+    // Si le coup TT est nettement meilleur que tous les autres (recherche réduite qui l'exclut
+    // sous tt_score - 2*depth), on le prolonge d'un ply.
+    // Si même sans lui on dépasse beta, plusieurs coups coupent : multi-cut.
+    int singular_extension = 0;
+    if (!root_node && depth >= 8 && tt_move != MOVE_NONE && excluded == MOVE_NONE
+        && tt_depth >= depth - 3 && (tt_flag == TT_BETA || tt_flag == TT_EXACT)
+        && std::abs(tt_score) < VALUE_MATE_IN_MAX_PLY) {
+        int singular_beta = tt_score - 2 * depth;
+        ss->excluded_move = tt_move;
+        int score = search<NON_PV>(board, ss, (depth - 1) / 2, singular_beta - 1, singular_beta, cut_node);
+        ss->excluded_move = MOVE_NONE;
+        if (stop_flag) return 0;
+
+        if (score < singular_beta) singular_extension = 1;
+        else if (singular_beta >= beta) return singular_beta;
+    }
 
     std::vector<std::pair<int, Move>> sorted_moves;
-    sorted_moves.reserve(moves.size());
-    for (Move m : moves) {
-        sorted_moves.push_back({score_move(m, board, ply, tt_move), m});
+    if (root_node) {
+        // Déjà triés par l'itération précédente
+        for (size_t i = pv_idx; i < root_moves.size(); ++i)
+            sorted_moves.push_back({0, root_moves[i].move});
+    } else {
+        std::vector<Move> moves;
+        moves.reserve(256);
+        MoveGenerator::generate_pseudo_moves(board, moves);
+
+        sorted_moves.reserve(moves.size());
+        for (Move m : moves) {
+            if (m == excluded) continue;
+            sorted_moves.push_back({score_move(m, board, ss, tt_move), m});
+        }
+        std::sort(sorted_moves.rbegin(), sorted_moves.rend());
     }
-    std::sort(sorted_moves.rbegin(), sorted_moves.rend());
 
-    int best_score = -50000;
+    int best_score = -VALUE_INFINITE;
     Move best_move_found = MOVE_NONE;
     int legal_moves_count = 0;
+    Move quiets_tried[64];
+    int quiet_count = 0;
+    Move captures_tried[32];
+    int capture_count = 0;
     
     for (size_t i = 0; i < sorted_moves.size(); ++i) {
         Move move = sorted_moves[i].second;
         Board next = board;
         next.make_move(move);
+        TT::prefetch(next.hash_key);
         
         if (!is_legal(next)) continue;
         legal_moves_count++;
 
-        // 4. LATE MOVE REDUCTION (LMR) - Version Sécurisée
-        int reduction = 0;
-        bool is_capture = (board.piece_at(get_to_sq(move)) != NO_PIECE);
-        bool is_killer = (move == killer_moves[ply][0] || move == killer_moves[ply][1]);
+        int piece = board.piece_at(get_from_sq(move));
+        Square to = get_to_sq(move);
+        bool is_capture = (board.piece_at(to) != NO_PIECE);
         bool is_promotion = (get_move_type(move) == MOVE_TYPE_PROMOTION);
+        bool is_quiet = !is_capture && !is_promotion;
+        bool is_killer = (move == ss->killers[0] || move == ss->killers[1]);
+        bool gives_check = next.is_in_check();
+        int move_history = is_quiet ? quiet_history(ss, piece, to) : 0;
+
+        int reduction = 0;
+        if (depth >= 3 && legal_moves_count > 1 + (pv_node ? 1 : 0) && is_quiet) {
+            reduction = reductions[std::min(depth, 63)][std::min(legal_moves_count, 63)];
+            if (!improving) reduction++;
+            if (pv_node) reduction--;
+            if (is_killer) reduction--;
+            if (gives_check || in_check) reduction--;
+            reduction -= move_history / 8192;
+            reduction = std::clamp(reduction, 0, depth - 2);
+        }
 
-        if (depth >= 3 && i > 3 && !in_check && !is_capture && !is_killer && !is_promotion) {
-             reduction = 1;
-             if (i > 8 && depth > 6) reduction = 2;
+        // 7. ÉLAGAGE DES QUIETS À FAIBLE PROFONDEUR
+        // Seulement une fois qu'un coup a été cherché, pour ne pas fabriquer de faux mats
+        if (!root_node && !in_check && is_quiet && !gives_check && best_score > VALUE_MATED_IN_MAX_PLY) {
+            // Move-count pruning : au-delà d'un certain nombre de quiets, les suivants coupent rarement
+            if (depth <= 8 && quiet_count >= (3 + depth * depth) / (improving ? 1 : 2)) continue;
+
+            // Futility : même avec une bonne marge, l'éval reste sous alpha
+            int lmr_depth = std::max(0, depth - 1 - reduction);
+            if (lmr_depth <= 8 && static_eval + 100 + 100 * lmr_depth <= alpha) continue;
         }
 
-        int score;
-        if (legal_moves_count == 1) {
-            score = -negamax(next, depth - 1, -beta, -alpha, ply + 1);
-        } else {
-            score = -negamax(next, depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+        ss->current_move = move;
+        ss->moved_piece = piece;
+        uint64_t nodes_before = nodes_searched;
+
+        // Extensions : coup qui donne échec, coup TT singulier
+        int extension = gives_check ? 1 : 0;
+        if (move == tt_move) extension = std::max(extension, singular_extension);
+        int new_depth = depth - 1 + extension;
+
+        // 8. PVS + LATE MOVE REDUCTION (LMR) - table logarithmique (voir Search::init)
+        // Fenêtre nulle pour tous les coups sauf le premier d'un noeud PV ;
+        // un noeud PV recherche de nouveau en PV tout coup qui entre dans la fenêtre.
+        // Les noeuds non-PV n'écrivent pas de variante : on vide celle de l'enfant
+        // pour ne jamais recopier une ligne périmée
+        if (pv_node) (ss + 1)->pv_length = 0;
+        int score = 0;
+        if (!pv_node || legal_moves_count > 1) {
+            // Un coup réduit est supposé échouer bas : l'enfant est un cut node
+            score = -search<NON_PV>(next, ss + 1, new_depth - reduction, -alpha - 1, -alpha,
+                                    reduction > 0 || !cut_node);
             if (score > alpha && reduction > 0) {
-                 score = -negamax(next, depth - 1, -alpha - 1, -alpha, ply + 1);
-            }
-            if (score > alpha && score < beta) {
-                score = -negamax(next, depth - 1, -beta, -alpha, ply + 1);
+                 score = -search<NON_PV>(next, ss + 1, new_depth, -alpha - 1, -alpha, !cut_node);
             }
         }
+        if (pv_node && (legal_moves_count == 1 || (score > alpha && (root_node || score < beta)))) {
+            score = -search<PV>(next, ss + 1, new_depth, -beta, -alpha, false);
+        }
         
+        if (root_node) {
+            RootMove& rm = *std::find_if(root_moves.begin() + pv_idx, root_moves.end(),
+                                         [move](const RootMove& r) { return r.move == move; });
+            rm.nodes += nodes_searched - nodes_before;
+            if (stop_flag) return best_score;
+
+            if (legal_moves_count == 1 || score > alpha) {
+                rm.score = score;
+                rm.pv.assign(1, move);
+                for (int p = 0; p < (ss + 1)->pv_length; ++p) rm.pv.push_back((ss + 1)->pv[p]);
+            } else {
+                // Borne supérieure seulement : on le classe derrière les coups exacts
+                rm.score = -VALUE_INFINITE;
+            }
+        }
+
         if (stop_flag) return 0;
         
         if (score > best_score) {
@@ -234,34 +643,62 @@ int Search::negamax(Board& board, int depth, int alpha, int beta, int ply) {
         
         if (score > alpha) {
             alpha = score;
-            if (ply < 64 && !is_capture) {
-                killer_moves[ply][1] = killer_moves[ply][0];
-                killer_moves[ply][0] = move;
-                int p = board.piece_at(get_from_sq(move));
-                if (p != NO_PIECE) history[p][get_to_sq(move)] += depth * depth;
+            if (pv_node) {
+                ss->pv[0] = move;
+                int child_length = std::min((ss + 1)->pv_length, MAX_PLY - 1);
+                for (int p = 0; p < child_length; ++p) ss->pv[p + 1] = (ss + 1)->pv[p];
+                ss->pv_length = child_length + 1;
             }
         }
-        if (alpha >= beta) break;
+        if (alpha >= beta) {
+            int bonus = history_bonus(depth);
+            if (!is_capture) update_quiet_stats(board, ss, move, depth, quiets_tried, quiet_count);
+            else update_capture_history(board, move, bonus);
+            // Les captures essayées avant la coupure n'ont pas suffi
+            for (int c = 0; c < capture_count; ++c) update_capture_history(board, captures_tried[c], -bonus);
+            break;
+        }
+        if (!is_capture && quiet_count < 64) quiets_tried[quiet_count++] = move;
+        if (is_capture && capture_count < 32) captures_tried[capture_count++] = move;
     }
 
     if (legal_moves_count == 0) {
-        if (in_check) return -49000 + ply;
+        // Recherche d'exclusion sans autre coup légal : le coup TT est forcément singulier
+        if (excluded != MOVE_NONE) return alpha;
+        if (in_check) return mated_in(ss->ply);
         // Contempt: On retourne 0 pour le pat.
         // Si le moteur gagne (+900), 0 est mauvais -> il évitera le pat.
         // Si le moteur perd (-900), 0 est bon -> il cherchera le pat.
         return 0;
     }
 
+    // Le drapeau se juge par rapport à la fenêtre d'entrée (alpha a pu monter depuis)
     int flag = TT_ALPHA;
     if (best_score >= beta) flag = TT_BETA;
-    else if (best_score > alpha) flag = TT_EXACT;
+    else if (best_score > alpha_orig) flag = TT_EXACT;
     
-    TT::store(board.hash_key, best_score, best_move_found, depth, flag, ply);
+    // À la racine, avec MultiPV, le résultat ne couvre qu'une partie des coups
+    if (!root_node && excluded == MOVE_NONE)
+        TT::store(board.hash_key, best_score, best_move_found, depth, flag, static_eval, ss->ply);
 
     return best_score;
 }
 
-Move Search::get_best_move(Board& board, int max_depth, int time_limit_ms) {
+int Search::negamax(Board& board, int depth, int alpha, int beta, int ply) {
+    SearchStack* ss = stack + STACK_OFFSET + std::clamp(ply, 0, MAX_PLY - 1);
+    if (beta - alpha > 1) return search<PV>(board, ss, depth, alpha, beta, false);
+    return search<NON_PV>(board, ss, depth, alpha, beta, false);
+}
+
+int Search::quiescence(Board& board, int alpha, int beta, int ply) {
+    SearchStack* ss = stack + STACK_OFFSET + std::clamp(ply, 0, MAX_PLY - 1);
+    if (beta - alpha > 1) return qsearch<PV>(board, ss, alpha, beta);
+    return qsearch<NON_PV>(board, ss, alpha, beta);
+}
+
+Move Search::get_best_move(Board& board, int max_depth) {
+    TimeManager::start();
+
     Move book_move = Book::get_book_move(board); 
     if (book_move != MOVE_NONE) {
         std::cout << "info string Book move joue !" << std::endl;
@@ -269,71 +706,120 @@ Move Search::get_best_move(Board& board, int max_depth, int time_limit_ms) {
     }
 
     reset_stats();
-    // Reset historique de recherche
-    for(int i=0; i<256; ++i) search_ply_history[i] = 0;
-    
-    start_time = std::chrono::steady_clock::now();
-    allotted_time_ms = (time_limit_ms > 50) ? time_limit_ms - 50 : time_limit_ms;
+    TT::new_search();
+    // Reset de la pile de recherche (évaluations, coups joués, variantes)
+    reset_stack();
+    SearchStack* ss = stack + STACK_OFFSET;
 
-    std::vector<Move> root_moves;
-    MoveGenerator::generate_legal_moves(board, root_moves);
-    if (root_moves.empty()) return MOVE_NONE;
+    std::vector<Move> legal_root;
+    MoveGenerator::generate_legal_moves(board, legal_root);
+    if (legal_root.empty()) return MOVE_NONE;
 
     std::vector<std::pair<int, Move>> sorted_root;
-    for (Move m : root_moves) {
-        sorted_root.push_back({score_move(m, board, 0, MOVE_NONE), m});
+    for (Move m : legal_root) {
+        sorted_root.push_back({score_move(m, board, ss, MOVE_NONE), m});
     }
     std::sort(sorted_root.rbegin(), sorted_root.rend());
 
-    Move best_move = sorted_root[0].second;
+    root_moves.assign(sorted_root.size(), RootMove());
+    for (size_t i = 0; i < sorted_root.size(); ++i) root_moves[i].move = sorted_root[i].second;
+
+    // On ne peut pas rapporter plus de lignes qu'il n'y a de coups légaux
+    const int pv_lines = std::min<int>(multi_pv, static_cast<int>(root_moves.size()));
+
+    Move best_move = root_moves[0].move;
+
+    auto root_move_order = [](const RootMove& a, const RootMove& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.previous_score > b.previous_score;
+    };
+
+    // Suivi pour le time manager
+    Move last_best_move = MOVE_NONE;
+    int best_move_stability = 0;
+    int last_best_score = 0;
 
     for (int depth = 1; depth <= max_depth; ++depth) {
-        if (allotted_time_ms > 0 && depth > 1) {
-             auto now = std::chrono::steady_clock::now();
-             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count();
-             if (elapsed > allotted_time_ms * 0.6) break; 
+        uint64_t iteration_start_nodes = nodes_searched;
+        for (auto& rm : root_moves) {
+            rm.previous_score = rm.score;
+            rm.nodes = 0;
         }
 
-        int alpha = -50000;
-        int beta = 50000;
-        int best_score_depth = -50000;
-        Move current_best_move = MOVE_NONE;
+        // MultiPV : la ligne k cherche tous les coups sauf les k-1 meilleurs déjà trouvés
+        // à cette profondeur. La TT est partagée, donc les lignes suivantes sont peu coûteuses.
+        for (pv_idx = 0; pv_idx < pv_lines; ++pv_idx) {
+            // Fenêtre d'aspiration centrée sur le score de l'itération précédente.
+            // En cas d'échec (fail high / fail low), on élargit exponentiellement.
+            int delta = 25;
+            int alpha = -VALUE_INFINITE;
+            int beta = VALUE_INFINITE;
+            int prev = root_moves[pv_idx].previous_score;
+            if (depth >= 4 && prev > -VALUE_INFINITE) {
+                alpha = std::max(prev - delta, -VALUE_INFINITE);
+                beta = std::min(prev + delta, VALUE_INFINITE);
+            }
 
-        // On enregistre la racine dans l'historique (ply 0)
-        search_ply_history[0] = board.hash_key;
+            while (true) {
+                int score = search<ROOT>(board, ss, depth, alpha, beta, false);
+                if (stop_flag) break;
 
-        for (auto& pair : sorted_root) {
-            Move m = pair.second;
-            Board next = board;
-            next.make_move(m);
-            // On appelle negamax avec ply = 1
-            int val = -negamax(next, depth - 1, -beta, -alpha, 1);
-            
-            if (stop_flag) break;
-            
-            if (val > best_score_depth) {
-                best_score_depth = val;
-                current_best_move = m;
+                // Tri stable : à score égal on garde l'ordre de l'itération précédente
+                std::stable_sort(root_moves.begin() + pv_idx, root_moves.end(), root_move_order);
+
+                if (pv_idx == 0) best_move = root_moves[0].move;
+
+                if (score <= alpha) {
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(score - delta, -VALUE_INFINITE);
+                } else if (score >= beta) {
+                    beta = std::min(score + delta, VALUE_INFINITE);
+                } else {
+                    break;
+                }
+                delta += delta / 2;
             }
-            if (val > alpha) alpha = val;
+
+            if (stop_flag) break;
+
+            // Les lignes déjà terminées sont retriées avec la nouvelle : une ligne
+            // plus loin peut dépasser une précédente, "multipv 1" reste la meilleure
+            std::stable_sort(root_moves.begin(), root_moves.begin() + pv_idx + 1, root_move_order);
+            best_move = root_moves[0].move;
         }
 
-        if (!stop_flag) {
-            best_move = current_best_move;
-            for (auto& pair : sorted_root) {
-                if (pair.second == best_move) pair.first = 100000; 
-                else pair.first = score_move(pair.second, board, 0, MOVE_NONE);
-            }
-            std::sort(sorted_root.rbegin(), sorted_root.rend());
+        if (stop_flag) break;
+
+        auto t = TimeManager::elapsed();
+        if (t == 0) t = 1;
 
-            auto t = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - start_time).count();
-            if (t == 0) t = 1;
-            
-            std::cout << "info depth " << depth << " score cp " << best_score_depth 
+        for (int line = 0; line < pv_lines; ++line) {
+            const RootMove& rm = root_moves[line];
+            std::cout << "info depth " << depth << " multipv " << (line + 1)
+                      << " score " << Uci::score_to_string(rm.score)
                       << " nodes " << nodes_searched << " time " << t 
-                      << " nps " << (nodes_searched * 1000 / t) << std::endl;
-        } else break;
+                      << " nps " << (nodes_searched * 1000 / t)
+                      << " hashfull " << TT::get_hash_full() << " pv";
+            for (Move m : rm.pv) std::cout << " " << Uci::move_to_string(m);
+            std::cout << std::endl;
+        }
+
+        // Faut-il lancer une itération de plus ?
+        if (TimeManager::enabled()) {
+            best_move_stability = (best_move == last_best_move) ? best_move_stability + 1 : 0;
+            uint64_t iteration_nodes = nodes_searched - iteration_start_nodes;
+            double fraction = iteration_nodes ? double(root_moves[0].nodes) / iteration_nodes : 1.0;
+            int score = root_moves[0].score;
+            int previous = (depth > 1) ? last_best_score : score;
+
+            if (TimeManager::should_stop(best_move_stability, score, previous, fraction)) break;
+
+            last_best_move = best_move;
+            last_best_score = score;
+        }
+
+        // go mate N : on s'arrête dès qu'un mat en N coups (ou moins) est trouvé
+        if (mate_limit > 0 && root_moves[0].score >= mate_in(2 * mate_limit - 1)) break;
     }
     return best_move;
 }
\ No newline at end of file
@@ -65,12 +65,12 @@ float SelfPlay::play_game(int depth, std::vector<TrainingPosition>& positions) {
             // RECHERCHE NORMALE
             // On utilise negamax directement pour avoir le score
             // Note: depth est faible pour la vitesse
-            score = Search::negamax(board, depth, -50000, 50000);
+            score = Search::negamax(board, depth, -VALUE_INFINITE, VALUE_INFINITE);
             
             // On récupère le meilleur coup via une petite recherche (ou TT si stocké)
             // Pour simplifier ici, on refait un get_best_move rapide
             // Idéalement on modifierait search pour retourner coup + score ensemble
-            best_move = Search::get_best_move(board, depth, 0); 
+            best_move = Search::get_best_move(board, depth); 
         }
 
         if (best_move == MOVE_NONE) break; // Devrait être géré par check_game_over
@@ -0,0 +1,62 @@
+#include "../include/timeman.h"
+#include <algorithm>
+
+std::chrono::steady_clock::time_point TimeManager::start_time;
+int64_t TimeManager::soft_limit_ms = 0;
+int64_t TimeManager::hard_limit_ms = 0;
+int TimeManager::move_overhead_ms = 30;
+
+void TimeManager::set_move_overhead(int ms) { move_overhead_ms = std::max(0, ms); }
+
+void TimeManager::start() { start_time = std::chrono::steady_clock::now(); }
+
+int64_t TimeManager::elapsed() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+}
+
+void TimeManager::init(int time_left, int increment, int moves_to_go, int move_time) {
+    soft_limit_ms = 0;
+    hard_limit_ms = 0;
+
+    // Temps fixe par coup : on utilise tout, moins la marge
+    if (move_time > 0) {
+        hard_limit_ms = std::max<int64_t>(1, move_time - move_overhead_ms);
+        soft_limit_ms = hard_limit_ms;
+        return;
+    }
+    if (time_left <= 0) return;
+
+    // Horizon : movestogo si le contrôle le donne, sinon on suppose ~30 coups restants
+    int64_t mtg = (moves_to_go > 0) ? std::min(moves_to_go, 50) : 30;
+    int64_t budget = std::max<int64_t>(1, time_left - move_overhead_ms);
+
+    int64_t soft = budget / mtg + increment * 3 / 4;
+    // Le hard limit peut dépasser le soft (coups difficiles) mais jamais vider l'horloge.
+    // Avec un seul coup avant le contrôle, on garde quand même une réserve.
+    int64_t hard_cap = (mtg == 1) ? budget * 3 / 4 : budget * 2 / 5;
+    int64_t hard = std::min(soft * 4, hard_cap);
+
+    hard_limit_ms = std::max<int64_t>(1, hard);
+    soft_limit_ms = std::clamp<int64_t>(soft, 1, hard_limit_ms);
+}
+
+bool TimeManager::should_stop(int best_move_stability, int score, int previous_score,
+                              double best_move_node_fraction) {
+    if (!enabled()) return false;
+
+    // Meilleur coup qui change souvent -> on prend plus de temps
+    static const double STABILITY_SCALE[5] = { 2.50, 1.20, 0.90, 0.80, 0.75 };
+    double stability = STABILITY_SCALE[std::clamp(best_move_stability, 0, 4)];
+
+    // Score qui chute -> position qui se complique, on réfléchit plus longtemps
+    double drop = std::clamp(1.0 + (previous_score - score) / 50.0, 0.8, 1.5);
+
+    // Si presque tous les noeuds vont au meilleur coup, il est probablement évident
+    double fraction = std::clamp(best_move_node_fraction, 0.0, 1.0);
+    double nodes = (1.5 - fraction) * 1.35;
+
+    double scaled = soft_limit_ms * stability * drop * nodes;
+    scaled = std::min(scaled, static_cast<double>(hard_limit_ms));
+    return elapsed() >= static_cast<int64_t>(scaled);
+}
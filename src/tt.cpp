@@ -1,153 +1,744 @@
 #include "tt.h"
+#include "zobrist.h"
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <chrono>
 #ifdef _MSC_VER
     #include <intrin.h>
+    #include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    #define TT_HAS_MMAP 1
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
 #endif
 
 // Transposition Table
-TTEntry* TT::table = nullptr;
+TTCluster* TT::table = nullptr;
 uint64_t TT::size = 0;
 uint64_t TT::mask = 0;
-uint64_t TT::entries_written = 0;
+uint8_t TT::generation8 = 0;
+TTStats TT::stats;
+TT::Backing TT::backing = TT::Backing::HEAP;
+void* TT::mapping = nullptr;
+uint64_t TT::mapping_bytes = 0;
 
-void TT::init(int size_mb) {
-    // Calculate number of entries (each entry is ~16 bytes: key=8, score=4, move=2, depth=1, flag=1)
-    // Actually, let's use 16 bytes per entry for alignment
+// Header of saved and mapped tables, followed by the raw clusters.
+// 64 bytes, so the clusters behind it stay cache-line aligned in a mapping.
+struct TTFileHeader {
+    char magic[8];
+    uint64_t zobrist;        // Zobrist::signature() of the keys the entries were made with
+    uint64_t clusters;
+    uint32_t cluster_bytes;  // sizeof(TTCluster), guards against layout changes
+    uint32_t generation;
+    uint64_t generation_time; // Wall-clock ms of the last generation bump (shared tables)
+    char reserved[24];
+};
+static_assert(sizeof(TTFileHeader) == 64, "TTFileHeader must keep clusters aligned");
+
+static constexpr char TT_MAGIC[8] = {'C', 'P', 'P', 'C', 'T', 'T', '0', '1'};
+
+static void fill_header(TTFileHeader& header, uint64_t clusters, uint8_t generation) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TT_MAGIC, sizeof(TT_MAGIC));
+    header.zobrist = Zobrist::signature();
+    header.clusters = clusters;
+    header.cluster_bytes = sizeof(TTCluster);
+    header.generation = generation;
+}
+
+// Empty string if the header describes a table this build can use
+static std::string check_header(const TTFileHeader& header) {
+    if (std::memcmp(header.magic, TT_MAGIC, sizeof(TT_MAGIC)) != 0) return "not a hash table file";
+    if (header.cluster_bytes != sizeof(TTCluster)) return "entry layout differs";
+    if (header.zobrist != Zobrist::signature()) return "written with different Zobrist keys";
+    if (header.clusters == 0 || (header.clusters & (header.clusters - 1)) != 0) return "bad cluster count";
+    return "";
+}
+
+// A mapped header may be shared with other processes. Its magic and generation are
+// only accessed atomically: an attaching process trusts the rest of the header once
+// the magic is published, and searches advance the one shared generation (see new_search)
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) && std::atomic<uint64_t>::is_always_lock_free,
+              "the header magic and generation time are accessed as atomic words");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "the header generation is accessed as an atomic word");
+
+static std::atomic<uint64_t>& header_magic(void* mapping) {
+    return *reinterpret_cast<std::atomic<uint64_t>*>(static_cast<TTFileHeader*>(mapping)->magic);
+}
+
+static std::atomic<uint32_t>& header_generation(void* mapping) {
+    return *reinterpret_cast<std::atomic<uint32_t>*>(&static_cast<TTFileHeader*>(mapping)->generation);
+}
+
+static std::atomic<uint64_t>& header_generation_time(void* mapping) {
+    return *reinterpret_cast<std::atomic<uint64_t>*>(&static_cast<TTFileHeader*>(mapping)->generation_time);
+}
+
+static uint64_t magic_word() {
+    uint64_t word;
+    std::memcpy(&word, TT_MAGIC, sizeof(word));
+    return word;
+}
+
+// gen_bound layout: the lower 2 bits hold the bound, the upper 6 the generation
+constexpr int GENERATION_BITS = 2;
+constexpr int GENERATION_DELTA = 1 << GENERATION_BITS;
+constexpr int GENERATION_CYCLE = 255 + GENERATION_DELTA;
+constexpr int GENERATION_MASK = (0xFF << GENERATION_BITS) & 0xFF;
+// Minimum time between two bumps of a mapped table's generation
+constexpr uint64_t GENERATION_INTERVAL_MS = 1000;
+
+// 16-bit digest of a data word, XORed into the stored key check
+static uint16_t fold16(uint64_t data) {
+    return static_cast<uint16_t>(data ^ (data >> 16) ^ (data >> 32) ^ (data >> 48));
+}
+
+// Statistics counter increment (see TTStats)
+static void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Age of an entry in generations (handles the wrap-around of generation8)
+static int relative_age(uint8_t gen_bound, uint8_t generation) {
+    return ((GENERATION_CYCLE + generation - gen_bound) & GENERATION_MASK) >> GENERATION_BITS;
+}
+
+// Large tables are allocated on 2 MB boundaries so the kernel can back them
+// with huge pages: one TLB entry then covers 2 MB of table instead of 4 KB
+constexpr size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+static void* large_page_alloc(size_t bytes) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, LARGE_PAGE_SIZE);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    size_t rounded = (bytes + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE * LARGE_PAGE_SIZE;
+    void* mem = std::aligned_alloc(LARGE_PAGE_SIZE, rounded);
+    #if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (mem) madvise(mem, rounded, MADV_HUGEPAGE);
+    #endif
+    return mem;
+#endif
+}
+
+static void large_page_free(void* mem) {
+#if defined(_WIN32)
+    _aligned_free(mem);
+#else
+    std::free(mem);
+#endif
+}
+
+// Number of clusters for size_mb: the largest power of 2 that fits
+static uint64_t cluster_count(int size_mb) {
+    // Calculate number of clusters (32 bytes each, CLUSTER_SIZE entries of 10 bytes)
     uint64_t bytes = static_cast<uint64_t>(size_mb) * 1024 * 1024;
-    uint64_t num_entries = bytes / sizeof(TTEntry);
+    uint64_t num_entries = bytes / sizeof(TTCluster);
     
     // Round down to power of 2 for fast indexing
     // Find the largest power of 2 <= num_entries
     #ifdef _MSC_VER
-        #include <intrin.h>
         unsigned long index;
         if (_BitScanReverse64(&index, num_entries)) {
-            size = 1ULL << index;
-        } else {
-            size = 1;
+            return 1ULL << index;
         }
+        return 1;
     #else
         if (num_entries > 0) {
-            size = 1ULL << (63 - __builtin_clzll(num_entries));
-        } else {
-            size = 1;
+            return 1ULL << (63 - __builtin_clzll(num_entries));
         }
+        return 1;
     #endif
+}
+
+void TT::release() {
+    if (!table) return;
+    if (backing == Backing::MAPPED) {
+#ifdef TT_HAS_MMAP
+        // The header generation is already current (see new_search): nothing to write back
+        munmap(mapping, mapping_bytes);
+#endif
+        mapping = nullptr;
+        mapping_bytes = 0;
+    } else {
+        large_page_free(table);
+    }
+    table = nullptr;
+    size = 0;
+    mask = 0;
+    backing = Backing::HEAP;
+}
+
+void TT::init(int size_mb) {
+    // Resizing: release the previous table first
+    release();
     
+    size = cluster_count(size_mb);
     mask = size - 1;
     
     // Allocate table
-    table = new TTEntry[size];
+    table = static_cast<TTCluster*>(large_page_alloc(size * sizeof(TTCluster)));
+    if (!table) {
+        std::cout << "info string Failed to allocate " << size_mb << " MB for the hash table" << std::endl;
+        size = 0;
+        mask = 0;
+        return;
+    }
     clear();
 }
 
+bool TT::is_persistent() {
+    return backing == Backing::MAPPED;
+}
+
+#ifdef TT_HAS_MMAP
+// Map the first bytes of fd read-write and shared, nullptr on failure
+static void* map_bytes(int fd, uint64_t bytes, const std::string& name) {
+    void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        std::cout << "info string Cannot map " << name << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    #if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // Honoured for shared memory when shmem huge pages are enabled, ignored for files
+        madvise(mem, bytes, MADV_HUGEPAGE);
+    #endif
+    return mem;
+}
+#endif
+
+bool TT::map_file(const std::string& path, int size_mb, bool resize) {
+#ifdef TT_HAS_MMAP
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cout << "info string Cannot open hash file " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Only an empty file or one of our own tables may be written: anything else is left alone
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cout << "info string Cannot open hash file " << path << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+    if (st.st_size > 0) {
+        TTFileHeader header{};
+        std::string error = "not a hash table file";
+        if (static_cast<uint64_t>(st.st_size) >= sizeof(header)
+            && pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))) {
+            error = check_header(header);
+            if (error.empty() && static_cast<uint64_t>(st.st_size) != sizeof(header) + header.clusters * sizeof(TTCluster)) {
+                error = "size does not match its header";
+            }
+        }
+        if (!error.empty()) {
+            std::cout << "info string Hash file " << path << " left untouched: " << error << std::endl;
+            close(fd);
+            return false;
+        }
+        
+        // A table of another size: the Hash option wins once it has been set,
+        // before that the file keeps its own size
+        if (header.clusters != cluster_count(size_mb)) {
+            uint64_t file_mb = header.clusters * sizeof(TTCluster) / (1024 * 1024);
+            if (resize) {
+                release(); // The current table may be this very file
+                if (ftruncate(fd, 0) != 0) {
+                    std::cout << "info string Cannot resize hash file " << path << ": " << std::strerror(errno) << std::endl;
+                    close(fd);
+                    return false;
+                }
+                std::cout << "info string Hash file " << path << " held a " << file_mb
+                          << " MB table, recreated at the Hash size" << std::endl;
+            } else {
+                std::cout << "info string Hash file " << path << " keeps its " << file_mb
+                          << " MB table (Hash is " << size_mb << " MB)" << std::endl;
+            }
+        }
+    }
+    
+    bool ok = map_fd(fd, size_mb, "hash file " + path);
+    close(fd);
+    return ok;
+#else
+    (void)size_mb;
+    std::cout << "info string Hash file " << path << ": mmap not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+bool TT::map_shared(const std::string& name, int size_mb) {
+#ifdef TT_HAS_MMAP
+    // POSIX names are "/something"
+    std::string shm_name = (!name.empty() && name[0] == '/') ? name : "/" + name;
+    std::string label = "shared memory " + shm_name;
+    uint64_t clusters = cluster_count(size_mb);
+    
+    // Exactly one process creates and sizes the segment (O_EXCL). The others never
+    // truncate it: they wait for the creator to publish the header, then attach
+    int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        uint64_t bytes = sizeof(TTFileHeader) + clusters * sizeof(TTCluster);
+        void* mem = nullptr;
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0 || !(mem = map_bytes(fd, bytes, label))) {
+            if (!mem) std::cout << "info string Cannot size " << label << ": " << std::strerror(errno) << std::endl;
+            close(fd);
+            shm_unlink(shm_name.c_str());
+            return false;
+        }
+        close(fd);
+        
+        // The new segment is zero-filled: write the header, magic last
+        TTFileHeader header;
+        fill_header(header, clusters, 0);
+        std::memcpy(static_cast<char*>(mem) + sizeof(header.magic), reinterpret_cast<char*>(&header) + sizeof(header.magic),
+                    sizeof(header) - sizeof(header.magic));
+        header_magic(mem).store(magic_word(), std::memory_order_release);
+        adopt_mapping(mem, bytes, clusters, false, label);
+        return true;
+    }
+    if (errno != EEXIST || (fd = shm_open(shm_name.c_str(), O_RDWR, 0)) < 0) {
+        std::cout << "info string Cannot open " << label << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Attach: wait (up to 5 s) for the creator to size the segment and publish its header
+    for (int attempt = 0; attempt < 500; attempt++) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) break;
+        uint64_t bytes = static_cast<uint64_t>(st.st_size);
+        if (bytes >= sizeof(TTFileHeader)) {
+            void* mem = map_bytes(fd, bytes, label);
+            if (!mem) break;
+            uint64_t magic = header_magic(mem).load(std::memory_order_acquire);
+            if (magic != 0) {
+                const TTFileHeader* header = static_cast<const TTFileHeader*>(mem);
+                std::string error = check_header(*header);
+                if (error.empty() && bytes != sizeof(TTFileHeader) + header->clusters * sizeof(TTCluster)) {
+                    error = "size does not match its header";
+                }
+                if (!error.empty()) {
+                    std::cout << "info string " << label << " left untouched: " << error << std::endl;
+                    munmap(mem, bytes);
+                    close(fd);
+                    return false;
+                }
+                // Attached processes share the creator's size
+                if (header->clusters != clusters) {
+                    std::cout << "info string " << label << " keeps its "
+                              << header->clusters * sizeof(TTCluster) / (1024 * 1024)
+                              << " MB table (Hash is " << size_mb << " MB)" << std::endl;
+                }
+                close(fd);
+                adopt_mapping(mem, bytes, header->clusters, true, label);
+                return true;
+            }
+            munmap(mem, bytes);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    close(fd);
+    std::cout << "info string " << label << " was never initialised (stale segment? remove it with shm_unlink)" << std::endl;
+    return false;
+#else
+    (void)size_mb;
+    std::cout << "info string Shared memory hash " << name << ": not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void TT::adopt_mapping(void* mem, uint64_t bytes, uint64_t clusters, bool reused, const std::string& name) {
+    release();
+    backing = Backing::MAPPED;
+    mapping = mem;
+    mapping_bytes = bytes;
+    table = reinterpret_cast<TTCluster*>(static_cast<char*>(mem) + sizeof(TTFileHeader));
+    size = clusters;
+    mask = size - 1;
+    generation8 = static_cast<uint8_t>(header_generation(mem).load(std::memory_order_relaxed));
+    reset_stats();
+    
+    std::cout << "info string Hash mapped to " << name << ", "
+              << (clusters * sizeof(TTCluster)) / (1024 * 1024) << " MB, "
+              << (reused ? "existing table reused" : "new table") << std::endl;
+}
+
+bool TT::map_fd(int fd, int size_mb, const std::string& name) {
+#ifdef TT_HAS_MMAP
+    // Reuse a valid table already in the file (its own size wins), otherwise start a new one.
+    // Callers only hand over empty files or files holding one of our tables
+    uint64_t clusters = cluster_count(size_mb);
+    TTFileHeader header{};
+    bool reuse = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) >= sizeof(header)
+        && pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+        && check_header(header).empty()
+        && static_cast<uint64_t>(st.st_size) == sizeof(header) + header.clusters * sizeof(TTCluster)) {
+        clusters = header.clusters;
+        reuse = true;
+    }
+    
+    uint64_t bytes = sizeof(TTFileHeader) + clusters * sizeof(TTCluster);
+    // Truncating to 0 first guarantees a zero-filled (empty) table
+    if (!reuse && (ftruncate(fd, 0) != 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0)) {
+        std::cout << "info string Cannot size " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    void* mem = map_bytes(fd, bytes, name);
+    if (!mem) return false;
+    if (!reuse) fill_header(*static_cast<TTFileHeader*>(mem), clusters, 0);
+    adopt_mapping(mem, bytes, clusters, reuse, name);
+    return true;
+#else
+    (void)fd; (void)size_mb; (void)name;
+    return false;
+#endif
+}
+
+bool TT::save(const std::string& path) {
+    if (!table) return false;
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    TTFileHeader header;
+    fill_header(header, size, generation8);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table), static_cast<std::streamsize>(size * sizeof(TTCluster)));
+    if (!out) {
+        std::cout << "info string Cannot write hash table to " << path << std::endl;
+        return false;
+    }
+    std::cout << "info string Hash table saved to " << path << std::endl;
+    return true;
+}
+
+bool TT::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    TTFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cout << "info string Cannot read hash table from " << path << std::endl;
+        return false;
+    }
+    std::string error = check_header(header);
+    if (!error.empty()) {
+        std::cout << "info string Cannot load " << path << ": " << error << std::endl;
+        return false;
+    }
+    
+    // The saved table keeps its size: resize to it (a mapped table can't be resized)
+    if (header.clusters != size) {
+        uint64_t mb = header.clusters * sizeof(TTCluster) / (1024 * 1024);
+        if (backing == Backing::MAPPED || mb == 0) {
+            std::cout << "info string Cannot load " << path << ": size differs from the current table" << std::endl;
+            return false;
+        }
+        init(static_cast<int>(mb));
+        if (size != header.clusters) return false;
+    }
+    
+    if (!in.read(reinterpret_cast<char*>(table), static_cast<std::streamsize>(size * sizeof(TTCluster)))) {
+        std::cout << "info string Truncated hash table file " << path << std::endl;
+        clear();
+        return false;
+    }
+    generation8 = static_cast<uint8_t>(header.generation);
+    reset_stats();
+    std::cout << "info string Hash table loaded from " << path << std::endl;
+    return true;
+}
+
 void TT::clear() {
     if (table) {
-        std::memset(table, 0, size * sizeof(TTEntry));
+        // Tables of several GB take seconds to zero on one core: split the work
+        // across hardware threads (which also spreads first-touch page faults)
+        const uint64_t bytes = size * sizeof(TTCluster);
+        const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        if (threads == 1 || bytes < 64ULL * 1024 * 1024) {
+            std::memset(static_cast<void*>(table), 0, bytes);
+        } else {
+            std::vector<std::thread> workers;
+            const uint64_t chunk = size / threads;
+            for (unsigned t = 0; t < threads; t++) {
+                uint64_t start = t * chunk;
+                uint64_t count = (t == threads - 1) ? size - start : chunk;
+                workers.emplace_back([start, count]() {
+                    std::memset(static_cast<void*>(table + start), 0, count * sizeof(TTCluster));
+                });
+            }
+            for (std::thread& worker : workers) worker.join();
+        }
+    }
+    generation8 = 0;
+    reset_stats();
+}
+
+void TT::reset_stats() {
+    for (std::atomic<uint64_t>* counter : { &stats.probes, &stats.hits, &stats.cutoffs, &stats.stores,
+                                            &stats.store_empty, &stats.store_same, &stats.store_kept,
+                                            &stats.evict_old, &stats.evict_current }) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+void TT::new_search() {
+    if (backing == Backing::MAPPED) {
+        // A mapped table outlives the process and may be shared with other processes:
+        // the generation lives in the header. Bumping it on every search would make it
+        // run N times faster with N processes and wrap within a few moves, so that
+        // fresh entries of one process look old to the others. It moves forward at most
+        // once per GENERATION_INTERVAL_MS instead; the first search past the interval
+        // wins the CAS and bumps it, every search loads it.
+        uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        uint64_t last = header_generation_time(mapping).load(std::memory_order_relaxed);
+        if (now - last >= GENERATION_INTERVAL_MS  // Also true when the clock went backwards
+            && header_generation_time(mapping).compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            header_generation(mapping).fetch_add(GENERATION_DELTA, std::memory_order_relaxed);
+        }
+        generation8 = static_cast<uint8_t>(header_generation(mapping).load(std::memory_order_relaxed));
+    } else {
+        generation8 += GENERATION_DELTA;
     }
-    entries_written = 0;
 }
 
 int TT::adjust_mate_score(int score, int ply) {
-    // Mate scores are relative to the root
-    // When storing, we need to adjust them to be relative to current position
-    if (score > 20000) {
-        // Mate in N for current side
+    // In the search, mate scores count plies from the root.
+    // In the table they must count plies from this node, because the same
+    // position can be reached at a different ply later.
+    if (score >= VALUE_MATE_IN_MAX_PLY) {
         return score + ply;
-    } else if (score < -20000) {
-        // Mate in N for opponent
+    } else if (score <= VALUE_MATED_IN_MAX_PLY) {
         return score - ply;
     }
     return score;
 }
 
 int TT::restore_mate_score(int score, int ply) {
-    // Restore mate scores to be relative to root (they were stored relative to root)
-    // Actually, we don't need to adjust here - we'll adjust in the search function
+    // Exact inverse of adjust_mate_score, using the ply of the probing node
+    if (score >= VALUE_MATE_IN_MAX_PLY) {
+        return score - ply;
+    } else if (score <= VALUE_MATED_IN_MAX_PLY) {
+        return score + ply;
+    }
     return score;
 }
 
-bool TT::probe(uint64_t key, int& score, Move& move, int& depth, int& flag, 
-               int current_depth, int alpha, int beta) {
+uint64_t TT::pack(const TTEntry& entry) {
+    return static_cast<uint64_t>(entry.move)
+         | static_cast<uint64_t>(static_cast<uint16_t>(entry.score)) << 16
+         | static_cast<uint64_t>(static_cast<uint16_t>(entry.eval)) << 32
+         | static_cast<uint64_t>(entry.depth8) << 48
+         | static_cast<uint64_t>(entry.gen_bound) << 56;
+}
+
+TTEntry TT::unpack(uint64_t data) {
+    TTEntry entry;
+    entry.move = static_cast<Move>(data);
+    entry.score = static_cast<int16_t>(data >> 16);
+    entry.eval = static_cast<int16_t>(data >> 32);
+    entry.depth8 = static_cast<uint8_t>(data >> 48);
+    entry.gen_bound = static_cast<uint8_t>(data >> 56);
+    return entry;
+}
+
+bool TT::probe(uint64_t key, int& score, Move& move, int& depth, int& flag, int& eval,
+               int current_depth, int alpha, int beta, int ply) {
     if (!table) return false;
     
-    uint64_t index = key & mask;
-    TTEntry& entry = table[index];
+    TTCluster& cluster = table[key & mask];
+    const uint16_t key16 = static_cast<uint16_t>(key >> 48);
+    bump(stats.probes);
     
-    // Check if entry matches (key verification)
-    if (entry.key != key) {
+    int slot = -1;
+    uint64_t data = 0;
+    for (int i = 0; i < CLUSTER_SIZE; i++) {
+        // Check if entry matches (key verification, also rejects torn entries)
+        data = cluster.data[i].load(std::memory_order_relaxed);
+        uint16_t check = cluster.key16[i].load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ fold16(data)) == key16) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
         return false;
     }
+    bump(stats.hits);
+    TTEntry entry = unpack(data);
     
-    // Check if entry depth is sufficient
-    if (entry.depth < current_depth) {
-        return false;
+    // Still useful: keep it from being aged out
+    if ((entry.gen_bound & GENERATION_MASK) != generation8) {
+        entry.gen_bound = static_cast<uint8_t>(generation8 | (entry.gen_bound & (GENERATION_DELTA - 1)));
+        uint64_t refreshed = pack(entry);
+        cluster.data[slot].store(refreshed, std::memory_order_relaxed);
+        cluster.key16[slot].store(key16 ^ fold16(refreshed), std::memory_order_relaxed);
     }
     
-    // Restore mate scores (they were stored relative to root, now restore to current position)
-    int stored_score = entry.score;
-    score = restore_mate_score(stored_score, 0);  // Restore to root-relative
+    // Restore mate scores (stored relative to the node, the search wants them relative to root)
+    score = restore_mate_score(entry.score, ply);
     
-    // Return stored values
+    // Return stored values even when the entry is too shallow for a cutoff:
+    // the move still helps ordering, and depth/flag drive singular extensions.
+    // With a 16-bit key check the move may belong to another position:
+    // callers validate it before use (MoveGenerator::is_pseudo_legal)
     move = entry.move;
-    depth = entry.depth;
-    flag = entry.flag;
+    depth = entry.depth8 - 1;
+    flag = entry.gen_bound & (GENERATION_DELTA - 1);
+    eval = entry.eval;
     
-    // Check if we can use this entry based on flag
-    if (entry.flag == TT_EXACT) {
-        return true;  // Always usable
-    } else if (entry.flag == TT_ALPHA) {
-        // Upper bound: stored score <= alpha means we can cutoff
-        if (score <= alpha) {
-            return true;
-        }
-    } else if (entry.flag == TT_BETA) {
-        // Lower bound: stored score >= beta means we can cutoff
-        if (score >= beta) {
-            return true;
-        }
+    // Check if entry depth is sufficient
+    if (depth < current_depth) {
+        return false;
     }
     
-    return false;
+    // Check if we can use this entry based on flag
+    // Exact: always usable; upper bound: score <= alpha; lower bound: score >= beta
+    bool usable = (flag == TT_EXACT)
+               || (flag == TT_ALPHA && score <= alpha)
+               || (flag == TT_BETA && score >= beta);
+    if (usable) bump(stats.cutoffs);
+    return usable;
 }
 
-void TT::store(uint64_t key, int score, Move move, int depth, int flag, int ply) {
+void TT::store(uint64_t key, int score, Move move, int depth, int flag, int eval, int ply) {
     if (!table) return;
     
-    uint64_t index = key & mask;
-    TTEntry& entry = table[index];
+    TTCluster& cluster = table[key & mask];
+    const uint16_t key16 = static_cast<uint16_t>(key >> 48);
+    bump(stats.stores);
     
-    // Adjust mate scores for storage
-    score = adjust_mate_score(score, ply);
+    // Pick the slot: same position or an empty slot first, otherwise the entry
+    // with the lowest depth - 8 * age (shallow and old entries go first)
+    int slot = 0;
+    int worst = 0;
+    bool found = false;
+    bool same_position = false;
+    TTEntry old{};
+    for (int i = 0; i < CLUSTER_SIZE; i++) {
+        uint64_t data = cluster.data[i].load(std::memory_order_relaxed);
+        TTEntry e = unpack(data);
+        if (data == 0 || (cluster.key16[i].load(std::memory_order_relaxed) ^ fold16(data)) == key16) {
+            slot = i;
+            found = true;
+            same_position = (data != 0);
+            old = e;
+            break;
+        }
+        int value = e.depth8 - 8 * relative_age(e.gen_bound, generation8);
+        if (i == 0 || value < worst) {
+            slot = i;
+            worst = value;
+            old = e;
+        }
+    }
+    
+    if (!found) {
+        bump(relative_age(old.gen_bound, generation8) == 0 ? stats.evict_current : stats.evict_old);
+    } else if (!same_position) {
+        bump(stats.store_empty);
+    }
     
-    // Replacement strategy: Always Replace (simple and effective)
-    // Alternative: Depth-Preferred (store if new depth >= old depth)
-    // For now, use Always Replace for simplicity
-    if (entry.key == 0 || entry.depth <= depth) {
-        entry.key = key;
-        entry.score = score;
-        entry.move = move;
-        entry.depth = depth;
-        entry.flag = flag;
-        entries_written++;
+    // Same position: keep the old move if we have none to offer
+    if (same_position) {
+        if (move == MOVE_NONE) move = old.move;
+        // A much deeper result from this search is worth more than a shallow bound
+        if (flag != TT_EXACT && depth + 1 + 4 <= old.depth8
+            && relative_age(old.gen_bound, generation8) == 0) {
+            bump(stats.store_kept);
+            if (move == old.move) return;
+            old.move = move;
+            uint64_t data = pack(old);
+            cluster.data[slot].store(data, std::memory_order_relaxed);
+            cluster.key16[slot].store(key16 ^ fold16(data), std::memory_order_relaxed);
+            return;
+        }
     }
+    
+    if (same_position) bump(stats.store_same);
+    
+    // Adjust mate scores for storage
+    TTEntry entry;
+    entry.move = move;
+    entry.score = static_cast<int16_t>(adjust_mate_score(score, ply));
+    entry.eval = static_cast<int16_t>(eval);
+    entry.depth8 = static_cast<uint8_t>(std::clamp(depth + 1, 1, 255));
+    entry.gen_bound = static_cast<uint8_t>(generation8 | flag);
+    
+    uint64_t data = pack(entry);
+    cluster.data[slot].store(data, std::memory_order_relaxed);
+    cluster.key16[slot].store(key16 ^ fold16(data), std::memory_order_relaxed);
 }
 
 int TT::get_hash_full() {
     if (!table || size == 0) return 0;
     
-    // Count non-empty entries (simple approximation)
-    // For better accuracy, we'd need to track this, but this is good enough
-    uint64_t sample_size = std::min(size, 1000ULL);
+    // Entries written (or refreshed by a probe) during the current search, in the
+    // first clusters: entries left over from earlier moves don't count as full
+    uint64_t sample_size = std::min<uint64_t>(size, 1000);
     uint64_t filled = 0;
     
     for (uint64_t i = 0; i < sample_size; i++) {
-        if (table[i].key != 0) {
-            filled++;
+        for (int j = 0; j < CLUSTER_SIZE; j++) {
+            uint64_t data = table[i].data[j].load(std::memory_order_relaxed);
+            if (data != 0 && (unpack(data).gen_bound & GENERATION_MASK) == generation8) {
+                filled++;
+            }
         }
     }
     
-    return static_cast<int>((filled * 1000) / sample_size);
+    return static_cast<int>((filled * 1000) / (sample_size * CLUSTER_SIZE));
 }
 
+void TT::print_stats() {
+    // Full scan of the table: occupancy by age
+    uint64_t used = 0, current = 0, depth_sum = 0;
+    for (uint64_t i = 0; i < size; i++) {
+        for (int j = 0; j < CLUSTER_SIZE; j++) {
+            uint64_t data = table[i].data[j].load(std::memory_order_relaxed);
+            if (data == 0) continue;
+            TTEntry e = unpack(data);
+            used++;
+            depth_sum += e.depth8 - 1;
+            if ((e.gen_bound & GENERATION_MASK) == generation8) current++;
+        }
+    }
+    
+    const uint64_t entries = size * CLUSTER_SIZE;
+    auto pct = [](uint64_t part, uint64_t whole) {
+        return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    };
+    auto get = [](const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); };
+    
+    std::cout << std::fixed;
+    std::cout.precision(1);
+    std::cout << "TT size         : " << (size * sizeof(TTCluster)) / (1024 * 1024) << " MB, "
+              << size << " clusters, " << entries << " entries" << std::endl;
+    std::cout << "Generation      : " << (generation8 >> GENERATION_BITS) << std::endl;
+    std::cout << "Occupancy       : " << used << " used (" << pct(used, entries) << "%), "
+              << current << " from this search (" << pct(current, entries) << "%), "
+              << (used - current) << " older" << std::endl;
+    std::cout << "Average depth   : " << (used ? static_cast<double>(depth_sum) / used : 0.0) << std::endl;
+    std::cout << "hashfull        : " << get_hash_full() << std::endl;
+    std::cout << "Probes          : " << get(stats.probes) << ", hits " << get(stats.hits)
+              << " (" << pct(get(stats.hits), get(stats.probes)) << "%), cutoffs " << get(stats.cutoffs)
+              << " (" << pct(get(stats.cutoffs), get(stats.probes)) << "%)" << std::endl;
+    std::cout << "Stores          : " << get(stats.stores) << ", empty slot " << get(stats.store_empty)
+              << ", same position " << get(stats.store_same)
+              << ", deeper entry kept " << get(stats.store_kept) << std::endl;
+    std::cout << "Replacements    : " << get(stats.evict_old) << " older-search entries, "
+              << get(stats.evict_current) << " current-search entries (collisions, "
+              << pct(get(stats.evict_current), get(stats.stores)) << "% of stores)" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    std::cout.precision(6);
+}
@@ -1,13 +1,20 @@
 #include "uci.h"
 #include "movegenerator.h"
 #include "bitboard.h"
+#include "timeman.h"
+#include "tt.h"
+#include "book.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <cstdlib>
 
-Uci::Uci() : quit_flag(false) {
+// Graine du livre en mode déterministe
+static constexpr uint32_t DETERMINISTIC_SEED = 20240101;
+
+Uci::Uci() : quit_flag(false), deterministic(false), hash_mb(64) {
     // Board is initialized by default constructor
 }
 
@@ -39,6 +46,8 @@ void Uci::loop() {
             handle_position(line);
         } else if (command == "go") {
             handle_go(line);
+        } else if (command == "setoption") {
+            handle_setoption(line);
         } else if (command == "quit") {
             handle_quit();
             break;
@@ -46,6 +55,17 @@ void Uci::loop() {
             // Stop the search
             Search::stop_search();
             // Note: bestmove will be output when search completes or times out
+        } else if (command == "ttstats") {
+            // Instrumentation: hash table occupancy and replacement statistics, eval cache hit rate
+            TT::print_stats();
+            Evaluation::print_stats();
+        } else if (command == "ttsave" || command == "ttload") {
+            // ttsave <file> / ttload <file> : hash table persistence
+            std::string path = line.substr(command.size());
+            path.erase(0, path.find_first_not_of(" \t"));
+            if (path.empty()) std::cout << "info string usage: " << command << " <file>" << std::endl;
+            else if (command == "ttsave") TT::save(path);
+            else TT::load(path);
         } else if (command == "debug") {
             // Ignore debug command
         } else {
@@ -57,6 +77,13 @@ void Uci::loop() {
 void Uci::handle_uci() {
     std::cout << "id name CppChess Engine" << std::endl;
     std::cout << "id author Your Name" << std::endl;
+    std::cout << "option name Hash type spin default 64 min 1 max 65536" << std::endl;
+    std::cout << "option name Clear Hash type button" << std::endl;
+    std::cout << "option name Hash File type string default <empty>" << std::endl;
+    std::cout << "option name Hash Shared type string default <empty>" << std::endl;
+    std::cout << "option name MultiPV type spin default 1 min 1 max 256" << std::endl;
+    std::cout << "option name Move Overhead type spin default 30 min 0 max 5000" << std::endl;
+    std::cout << "option name Deterministic type check default false" << std::endl;
     std::cout << "uciok" << std::endl;
 }
 
@@ -68,6 +95,11 @@ void Uci::handle_ucinewgame() {
     // Reset board to starting position
     board.set_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
     Search::reset_stats();
+    // New game: forget everything learned, so the next search doesn't depend on the last game
+    // (except a file-backed hash, whose whole point is to survive across games)
+    Search::clear();
+    if (!TT::is_persistent()) TT::clear();
+    if (deterministic) Book::set_seed(DETERMINISTIC_SEED);
 }
 
 void Uci::handle_position(const std::string& command) {
@@ -112,13 +144,18 @@ void Uci::handle_go(const std::string& command) {
     
     int depth = 5; // Default depth
     int wtime = 0, btime = 0, winc = 0, binc = 0;
+    int movestogo = 0;
     int movetime = 0;
+    uint64_t nodes = 0;
+    int mate = 0;
+    bool depth_given = false;
     bool infinite = false;
     
     // Parse go parameters
     while (iss >> token) {
         if (token == "depth") {
             iss >> depth;
+            depth_given = true;
         } else if (token == "wtime") {
             iss >> wtime;
         } else if (token == "btime") {
@@ -127,35 +164,48 @@ void Uci::handle_go(const std::string& command) {
             iss >> winc;
         } else if (token == "binc") {
             iss >> binc;
+        } else if (token == "movestogo") {
+            iss >> movestogo;
         } else if (token == "movetime") {
             iss >> movetime;
+        } else if (token == "nodes") {
+            iss >> nodes;
+        } else if (token == "mate") {
+            iss >> mate;
         } else if (token == "infinite") {
             infinite = true;
         }
     }
     
-    // Calculate search time
-    int search_time_ms = 0;
-    if (movetime > 0) {
-        search_time_ms = movetime;
-    } else if (!infinite) {
-        if (board.side_to_move == WHITE && wtime > 0) {
-            search_time_ms = calculate_search_time(wtime, winc);
-        } else if (board.side_to_move == BLACK && btime > 0) {
-            search_time_ms = calculate_search_time(btime, binc);
-        }
+    // Node and mate limits (checked inside the search)
+    Search::set_node_limit(nodes);
+    Search::set_mate_limit(mate);
+    
+    // Time budget (soft/hard limits) for this move
+    // In deterministic mode the clock is ignored: only depth/nodes/mate limits apply
+    if (infinite || deterministic) {
+        TimeManager::init(0, 0, 0, 0);
+    } else if (board.side_to_move == WHITE) {
+        TimeManager::init(wtime, winc, movestogo, movetime);
+    } else {
+        TimeManager::init(btime, binc, movestogo, movetime);
     }
     
     // Perform search with iterative deepening
     Search::reset_stats();
     Move best_move = MOVE_NONE;
     
-    if (infinite || search_time_ms == 0) {
-        // No time limit: use fixed depth (or very high time limit)
-        best_move = Search::get_best_move(board, depth, 0);
+    if (!depth_given && (nodes > 0 || mate > 0)) {
+        // Node/mate limited search: deepen until the limit is hit
+        // (a mate in N needs 2N-1 plies, a little more leaves room for check lines)
+        int max_depth = (mate > 0 && nodes == 0) ? std::min(64, 2 * mate + 2) : 64;
+        best_move = Search::get_best_move(board, max_depth);
+    } else if (!TimeManager::enabled()) {
+        // No time limit: use fixed depth
+        best_move = Search::get_best_move(board, depth);
     } else {
         // Time-limited search with iterative deepening
-        best_move = Search::get_best_move(board, 64, search_time_ms);
+        best_move = Search::get_best_move(board, 64);
     }
     
     // Output best move
@@ -166,6 +216,52 @@ void Uci::handle_go(const std::string& command) {
     }
 }
 
+void Uci::handle_setoption(const std::string& command) {
+    // Format : setoption name <id> [value <x>] (le nom peut contenir des espaces)
+    std::istringstream iss(command);
+    std::string token, name, value;
+    iss >> token; // Skip "setoption"
+    iss >> token; // Skip "name"
+    
+    while (iss >> token && token != "value") {
+        if (!name.empty()) name += " ";
+        name += token;
+    }
+    while (iss >> token) {
+        if (!value.empty()) value += " ";
+        value += token;
+    }
+    
+    if (name == "Hash") {
+        hash_mb = std::clamp(std::atoi(value.c_str()), 1, 65536);
+        hash_set = true;
+        apply_hash_options();
+    } else if (name == "Hash File") {
+        hash_file = (value == "<empty>") ? "" : value;
+        apply_hash_options();
+    } else if (name == "Hash Shared") {
+        hash_shared = (value == "<empty>") ? "" : value;
+        apply_hash_options();
+    } else if (name == "Clear Hash") {
+        TT::clear();
+    } else if (name == "MultiPV") {
+        Search::set_multi_pv(std::clamp(std::atoi(value.c_str()), 1, 256));
+    } else if (name == "Move Overhead") {
+        TimeManager::set_move_overhead(std::clamp(std::atoi(value.c_str()), 0, 5000));
+    } else if (name == "Deterministic") {
+        deterministic = (value == "true");
+        if (deterministic) Book::set_seed(DETERMINISTIC_SEED);
+    }
+}
+
+void Uci::apply_hash_options() {
+    // Mémoire partagée d'abord, puis fichier, sinon table privée
+    if (!hash_shared.empty() && TT::map_shared(hash_shared, hash_mb)) return;
+    // Tant que Hash n'a pas été envoyé, un fichier existant garde sa taille
+    if (!hash_file.empty() && TT::map_file(hash_file, hash_mb, hash_set)) return;
+    TT::init(hash_mb);
+}
+
 void Uci::handle_quit() {
     quit_flag = true;
 }
@@ -243,6 +339,17 @@ Move Uci::parse_move(const std::string& move_str) {
     return MOVE_NONE;
 }
 
+std::string Uci::score_to_string(int score) {
+    if (score >= VALUE_MATE_IN_MAX_PLY) {
+        // Mate in (plies + 1) / 2 moves
+        return "mate " + std::to_string((VALUE_MATE - score + 1) / 2);
+    }
+    if (score <= VALUE_MATED_IN_MAX_PLY) {
+        return "mate " + std::to_string(-(VALUE_MATE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
 std::string Uci::move_to_string(Move move) {
     if (move == MOVE_NONE) return "0000";
     
@@ -283,16 +390,3 @@ std::string Uci::move_to_string(Move move) {
     
     return result;
 }
-
-int Uci::calculate_search_time(int time_left, int increment) {
-    // Simple time management: use time_left / 25
-    // Add increment for safety
-    int base_time = time_left / 25;
-    int safe_time = base_time + increment;
-    
-    // Don't use more than 90% of remaining time
-    int max_time = (time_left * 9) / 10;
-    
-    return std::min(safe_time, max_time);
-}
-
@@ -1,6 +1,4 @@
 #include "zobrist.h"
-#include <random>
-#include <chrono>
 
 namespace Zobrist {
     // Zobrist hash keys
@@ -9,10 +7,10 @@ namespace Zobrist {
     uint64_t castle_keys[16];
     uint64_t side_key;
     
-    // Simple PRNG for Zobrist keys (using linear congruential generator)
-    // This is deterministic and fast
+    // Simple PRNG for Zobrist keys (xorshift64*)
+    // Fixed seed: keys are identical on every run, so node counts are reproducible
     uint64_t random_u64() {
-        static uint64_t seed = std::chrono::steady_clock::now().time_since_epoch().count();
+        static uint64_t seed = 0x9E3779B97F4A7C15ULL;
         seed ^= seed >> 12;
         seed ^= seed << 25;
         seed ^= seed >> 27;
@@ -42,5 +40,16 @@ namespace Zobrist {
         // Initialize side to move key
         side_key = random_u64();
     }
+
+    uint64_t signature() {
+        // Order-dependent mix of every key: any change of seed or generator shows up
+        uint64_t sig = side_key;
+        auto mix = [&sig](uint64_t key) { sig = (sig ^ key) * 0x100000001B3ULL; };
+        for (int piece = 0; piece < 12; piece++)
+            for (int sq = 0; sq < 64; sq++) mix(piece_keys[piece][sq]);
+        for (int sq = 0; sq < 64; sq++) mix(en_passant_keys[sq]);
+        for (int c = 0; c < 16; c++) mix(castle_keys[c]);
+        return sig;
+    }
 }
 